@@ -6,7 +6,8 @@
 #include <string>
 #include "executionservice.hpp"
 #include "bondmarketdataservice.hpp"
-#include <iomanip>
+#include "securitymaster.hpp"
+#include <optional>
 
 #ifndef BONDALGOEXECUTIONSERVICE_HPP
 #define BONDALGOEXECUTIONSERVICE_HPP
@@ -51,15 +52,16 @@ public:
 class BondAlgoExecutionService
 {
 private:
-    map<string, AlgoExecution<Bond>> algoExecutions;
+    vector<std::optional<AlgoExecution<Bond>>> algoExecutions;  // by product index
     vector<ServiceListener<AlgoExecution<Bond>>*> listeners;
     BondMarketDataService* bondMarketDataService;
     BondAlgoExecutionServiceListener* listener;
     bool is_buy = true;
-    int next_order_ID = 1;
+    OrderId next_order_ID = 1;
 
 public:
     BondAlgoExecutionService(BondMarketDataService* _bondMarketDataService) : 
+        algoExecutions(SecurityMaster::Get().Size()),
         bondMarketDataService(_bondMarketDataService)        
     {
         listener = new BondAlgoExecutionServiceListener(this);
@@ -69,21 +71,22 @@ public:
     // Get data on our service given a key
     AlgoExecution<Bond>& GetData(string key) 
     {
-        auto it = algoExecutions.find(key);
-        if (it != algoExecutions.end()) {
-            return it->second;
+        uint32_t index = SecurityMaster::Get().Find(key);
+        if (index != ProductRegistry::NOT_FOUND && algoExecutions[index]) {
+            return *algoExecutions[index];
         }
         throw std::runtime_error("AlgoExecution not found for key: " + key);
     }
 
     // Add a new algo stream
-    void AddAlgoExecution(const string& key, const AlgoExecution<Bond>& algoExecution) 
+    void AddAlgoExecution(uint32_t productIndex, const AlgoExecution<Bond>& algoExecution) 
     {
-        algoExecutions.insert_or_assign(key, algoExecution);
+        std::optional<AlgoExecution<Bond>>& slot = algoExecutions[productIndex];
+        slot = algoExecution;
         
         // Notify all listeners
         for (auto& listener : listeners) {
-            listener->ProcessAdd(algoExecutions.find(key)->second);
+            listener->ProcessAdd(*slot);
         }
     }
 
@@ -91,27 +94,26 @@ public:
         // Create an execution order from the orderbook data
         PricingSide side;
         double quantity = 0;
-        double price = 0;
+        TreasuryPrice price;
         if (is_buy) {
-            vector<Order> offerStack = orderbook.GetOfferStack();
-            quantity += offerStack[0].GetQuantity();
-            price = offerStack[0].GetPrice();
+            Order bestOffer = orderbook.GetOffer(orderbook.BestOfferLevel());
+            quantity += bestOffer.GetQuantity();
+            price = bestOffer.GetPrice();
             side = PricingSide::BID;
         }
         else {
-            vector<Order> bidStack = orderbook.GetBidStack();
-            quantity += bidStack[0].GetQuantity();
-            price = bidStack[0].GetPrice();
+            Order bestBid = orderbook.GetBid(orderbook.BestBidLevel());
+            quantity += bestBid.GetQuantity();
+            price = bestBid.GetPrice();
             side = PricingSide::OFFER;
         }
         is_buy = !is_buy;
-        std::ostringstream oss;
-        oss << std::setfill('0') << std::setw(8) << next_order_ID;
-        ExecutionOrder<Bond> order(orderbook.GetProduct(), side, oss.str(), 
-            OrderType::MARKET, price, quantity, 0.0, oss.str(), false);
+        // The ID stays an integer until the order is printed
+        ExecutionOrder<Bond> order(orderbook.GetProduct(), side, next_order_ID,
+            OrderType::MARKET, price, quantity, 0.0, next_order_ID, false);
         AlgoExecution<Bond> algoExecution(order);
         next_order_ID++;
-        AddAlgoExecution(orderbook.GetProduct().GetProductId(), algoExecution);
+        AddAlgoExecution(SecurityMaster::Get().IndexOf(orderbook.GetProduct()), algoExecution);
     }
 
     // Add a listener to the Service
@@ -134,13 +136,12 @@ public:
 
 void BondAlgoExecutionServiceListener::ProcessAdd(OrderBook<Bond>& orderbook) 
 {
-    // Create a price stream from the price
-    Bond product = orderbook.GetProduct();
-    if (orderbook.GetBidStack().empty() || orderbook.GetOfferStack().empty()) {
+    if (orderbook.GetBidDepth() == 0 || orderbook.GetOfferDepth() == 0) {
         return;  // Cannot calculate spread with empty stacks
     }
-    double spread = orderbook.GetOfferStack()[0].GetPrice() - orderbook.GetBidStack()[0].GetPrice();
-    if (spread > 1.00001/128.0) { // Only execute if the spread is less than than 1/128
+    BidOffer bidOffer = orderbook.GetBestBidOffer();
+    TreasuryPrice spread = bidOffer.GetOfferOrder().GetPrice() - bidOffer.GetBidOrder().GetPrice();
+    if (spread > TreasuryPrice::FromTicks(2)) { // Only execute if the spread is at most 1/128
         return;
     }
     bondAlgoExecutionService->AggressOnBook(orderbook);
@@ -3,7 +3,9 @@
 #include "pricingservice.hpp"
 #include "bondpricingservice.hpp"
 #include "streamingservice.hpp"
+#include "securitymaster.hpp"
 #include <string>
+#include <optional>
 
 #ifndef BONDALGOSTREAMINGSERVICE_HPP
 #define BONDALGOSTREAMINGSERVICE_HPP
@@ -56,37 +58,47 @@ public:
 class BondAlgoStreamingService
 {
 private:
-    map<string, AlgoStream<Bond>> algoStreams;
+    vector<std::optional<AlgoStream<Bond>>> algoStreams;  // by product index
     vector<ServiceListener<AlgoStream<Bond>>*> listeners;
-    BondPricingService* bondPricingService;
+    Service<string, Price<Bond>>* bondPricingService;
     BondAlgoStreamingServiceListener* listener;
 
 public:
-    BondAlgoStreamingService(BondPricingService* _bondPricingService) : 
+    // Subscribes to the pricing service if given; otherwise wire GetListener() up yourself
+    BondAlgoStreamingService(Service<string, Price<Bond>>* _bondPricingService = nullptr) : 
+        algoStreams(SecurityMaster::Get().Size()),
         bondPricingService(_bondPricingService)        
     {
         listener = new BondAlgoStreamingServiceListener(this);
-        bondPricingService->AddListener(listener);
+        if (bondPricingService != nullptr) {
+            bondPricingService->AddListener(listener);
+        }
+    }
+
+    // Get the listener that feeds prices into this service
+    BondAlgoStreamingServiceListener* GetListener() {
+        return listener;
     }
 
     // Get data on our service given a key
     AlgoStream<Bond>& GetData(string key) 
     {
-        auto it = algoStreams.find(key);
-        if (it != algoStreams.end()) {
-            return it->second;
+        uint32_t index = SecurityMaster::Get().Find(key);
+        if (index != ProductRegistry::NOT_FOUND && algoStreams[index]) {
+            return *algoStreams[index];
         }
         throw std::runtime_error("AlgoStream not found for key: " + key);
     }
 
     // Add a new algo stream
-    void AddAlgoStream(const string& key, const AlgoStream<Bond>& algoStream) 
+    void AddAlgoStream(uint32_t productIndex, const AlgoStream<Bond>& algoStream) 
     {
-        algoStreams.insert_or_assign(key, algoStream);
+        std::optional<AlgoStream<Bond>>& slot = algoStreams[productIndex];
+        slot = algoStream;
         
         // Notify all listeners
         for (auto& listener : listeners) {
-            listener->ProcessAdd(algoStreams.find(key)->second);
+            listener->ProcessAdd(*slot);
         }
     }
 
@@ -111,13 +123,13 @@ public:
 void BondAlgoStreamingServiceListener::ProcessAdd(Price<Bond>& price) 
 {
     // Create a price stream from the price
-    Bond product = price.GetProduct();
-    double mid = price.GetMid();
-    double spread = price.GetBidOfferSpread();
+    const Bond& product = price.GetProduct();
+    TreasuryPrice mid = price.GetMid();
+    TreasuryPrice spread = price.GetBidOfferSpread();
     
-    // Calculate bid/offer prices and quantities
-    double bidPrice = mid - spread/2.0;
-    double offerPrice = mid + spread/2.0;
+    // Calculate bid/offer prices and quantities; feed spreads are whole 128ths, so halving is exact
+    TreasuryPrice bidPrice = mid - TreasuryPrice::FromTicks(spread.Ticks() / 2);
+    TreasuryPrice offerPrice = bidPrice + spread;
     
     // Static variable to track alternating state
     static bool alternateState = false;
@@ -137,8 +149,7 @@ void BondAlgoStreamingServiceListener::ProcessAdd(Price<Bond>& price)
     AlgoStream<Bond> algoStream(product, bidOrder, offerOrder);
     
     // Update the algo stream
-    string productId = product.GetProductId();
-    bondAlgoStreamingService->AddAlgoStream(productId, algoStream);
+    bondAlgoStreamingService->AddAlgoStream(SecurityMaster::Get().IndexOf(product), algoStream);
 }
 
 #endif
\ No newline at end of file
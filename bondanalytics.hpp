@@ -0,0 +1,232 @@
+/**
+ * bondanalytics.hpp
+ * Closed-form bond price and risk analytics on an accrual-aware semi-annual
+ * coupon schedule, precomputed per product and refreshed on curve moves.
+ */
+#ifndef BOND_ANALYTICS_HPP
+#define BOND_ANALYTICS_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include "products.hpp"
+#include "productregistry.hpp"
+
+using namespace std;
+using namespace boost::gregorian;
+
+/**
+ * Where the settlement date falls in a bond's semi-annual coupon schedule.
+ * Coupon dates are maturity less a whole number of six month periods, each
+ * taken from maturity itself so month ends stay on month ends (a 11/30
+ * maturity pays on 5/31 and 11/30) and other days do not drift (an 8/30
+ * maturity pays on 2/28 and 8/30). A bond at or past maturity has no
+ * remaining coupons and is priced at zero.
+ */
+struct CouponSchedule
+{
+  date previousCoupon;
+  date nextCoupon;
+  int remainingCoupons;    // coupons paid after settlement, including the one at maturity; 0 once matured
+  double accruedFraction;  // share of the current period elapsed at settlement, actual/actual
+};
+
+/**
+ * Price and risk of a bond per 100 face at one yield.
+ */
+struct BondAnalytics
+{
+  double yield;
+  double cleanPrice;
+  double dirtyPrice;
+  double accruedInterest;
+  double dv01;               // price change for a 1bp fall in yield
+  double macaulayDuration;   // years
+  double modifiedDuration;   // years
+  double convexity;          // years squared
+};
+
+// Build the coupon schedule of a bond as of the settlement date
+inline CouponSchedule BuildCouponSchedule(const date &maturity, const date &settlement)
+{
+  CouponSchedule schedule;
+  if (settlement >= maturity) {
+    schedule.previousCoupon = maturity;
+    schedule.nextCoupon = maturity;
+    schedule.remainingCoupons = 0;
+    schedule.accruedFraction = 0.0;
+    return schedule;
+  }
+  schedule.nextCoupon = maturity;
+  schedule.remainingCoupons = 1;
+  date previous = maturity - months(6);
+  while (previous > settlement) {
+    schedule.nextCoupon = previous;
+    schedule.remainingCoupons++;
+    previous = maturity - months(6 * schedule.remainingCoupons);
+  }
+  schedule.previousCoupon = previous;
+  double periodDays = (schedule.nextCoupon - previous).days();
+  schedule.accruedFraction = (settlement - previous).days() / periodDays;
+  return schedule;
+}
+
+/**
+ * Price a semi-annual bond in closed form.
+ * With v = 1/(1+y/2), n remaining coupons and w = 1 - accruedFraction periods
+ * to the next coupon, cash flow k is paid at t = k + w periods, so
+ *   dirty = v^w * (c * A + F * v^(n-1))
+ * where A, B, C are the geometric sums of v^k, k v^k and k^2 v^k over k < n.
+ * Duration and convexity come from the same sums, so no per-period pow calls.
+ */
+inline BondAnalytics PriceBond(double coupon, const CouponSchedule &schedule, double yield, double face = 100.0)
+{
+  int n = schedule.remainingCoupons;
+  if (n == 0) {
+    BondAnalytics matured{};
+    matured.yield = yield;
+    return matured;
+  }
+  double w = 1.0 - schedule.accruedFraction;
+  double rate = yield / 2.0;
+  double periodCoupon = coupon * face / 2.0;
+  double v = 1.0 / (1.0 + rate);
+  double vn = pow(v, n);
+  double vw = pow(v, w);
+
+  double A, B, C;
+  double oneMinusV = 1.0 - v;
+  if (fabs(oneMinusV) < 1e-12) {
+    A = n;
+    B = n * (n - 1) / 2.0;
+    C = (n - 1) * n * (2.0 * n - 1) / 6.0;
+  }
+  else {
+    double nd = n;
+    A = (1.0 - vn) / oneMinusV;
+    B = v * (1.0 - nd * vn / v + (nd - 1.0) * vn) / (oneMinusV * oneMinusV);
+    C = v * (1.0 + v - nd * nd * vn / v + (2.0 * nd * nd - 2.0 * nd - 1.0) * vn - (nd - 1.0) * (nd - 1.0) * vn * v)
+      / (oneMinusV * oneMinusV * oneMinusV);
+  }
+
+  // Discounted cash flows and their first two time moments, in periods
+  double lastTime = n - 1 + w;
+  double redemption = face * vn / v * vw;
+  double pv = vw * periodCoupon * A + redemption;
+  double timeWeighted = vw * periodCoupon * (B + w * A) + lastTime * redemption;
+  double timeSquaredWeighted = vw * periodCoupon * (C + 2.0 * w * B + w * w * A) + lastTime * lastTime * redemption;
+
+  BondAnalytics analytics;
+  analytics.yield = yield;
+  analytics.dirtyPrice = pv;
+  analytics.accruedInterest = periodCoupon * schedule.accruedFraction;
+  analytics.cleanPrice = pv - analytics.accruedInterest;
+  analytics.macaulayDuration = timeWeighted / pv / 2.0;
+  analytics.modifiedDuration = analytics.macaulayDuration * v;
+  // dP/dy = -v/2 * sum(t CF v^t); d2P/dy2 = v^2/4 * sum(t (t+1) CF v^t)
+  analytics.dv01 = timeWeighted * v / 2.0 * 0.0001;
+  analytics.convexity = (timeSquaredWeighted + timeWeighted) * v * v / 4.0 / pv;
+  return analytics;
+}
+
+/**
+ * Analytics for every product in the registry, indexed by product index.
+ * Schedules are built once per settlement date and each bond is priced once
+ * at its yield (its coupon, i.e. par, until a curve move says otherwise), so
+ * risk lookups are an array read. Not synchronised: callers serialise updates
+ * and reads for a product.
+ */
+class BondAnalyticsTable
+{
+
+public:
+
+  // Settlement date for the feed files, which are from early December 2024
+  static date DefaultSettlement() {
+    return date(2024, Dec, 2);
+  }
+
+  // ctor for a table priced at par yields as of the settlement date.
+  // Analytics precomputed for that date (one per product index) are used as is;
+  // the coupon schedules are then only built on the first repricing.
+  explicit BondAnalyticsTable(const ProductRegistry &registry, const date &settlement = DefaultSettlement(),
+                              const vector<BondAnalytics> *precomputed = nullptr) {
+    const vector<Bond> &bonds = registry.GetBonds();
+    coupons.reserve(bonds.size());
+    maturities.reserve(bonds.size());
+    for (const Bond &bond : bonds) {
+      coupons.push_back(bond.GetCoupon());
+      maturities.push_back(bond.GetMaturityDate());
+    }
+    if (precomputed != nullptr && precomputed->size() == bonds.size()) {
+      this->settlement = settlement;
+      analytics = *precomputed;
+      return;
+    }
+    analytics.resize(bonds.size());
+    SetSettlement(settlement);
+  }
+
+  // Get the analytics for a product index
+  const BondAnalytics& Get(uint32_t productIndex) const {
+    return analytics[productIndex];
+  }
+
+  // Whether a product had matured by the settlement date; its analytics are all zero
+  bool IsMatured(uint32_t productIndex) const {
+    return settlement >= maturities[productIndex];
+  }
+
+  // Get the DV01 per 100 face for a product index
+  double GetDV01(uint32_t productIndex) const {
+    return analytics[productIndex].dv01;
+  }
+
+  // Reprice one product after its yield moved
+  void SetYield(uint32_t productIndex, double yield) {
+    if (schedules.size() != maturities.size()) {
+      BuildSchedules();
+    }
+    analytics[productIndex] = PriceBond(coupons[productIndex], schedules[productIndex], yield);
+  }
+
+  // Reprice every product on a new curve, one yield per product index
+  void SetYields(const vector<double> &yields) {
+    for (uint32_t i = 0; i < analytics.size() && i < yields.size(); ++i) {
+      SetYield(i, yields[i]);
+    }
+  }
+
+  // Roll the schedules to a new settlement date and reprice at the current yields
+  void SetSettlement(const date &_settlement) {
+    settlement = _settlement;
+    BuildSchedules();
+    for (uint32_t i = 0; i < maturities.size(); ++i) {
+      double yield = analytics[i].dirtyPrice > 0 ? analytics[i].yield : coupons[i];
+      SetYield(i, yield);
+    }
+  }
+
+  const date& GetSettlement() const {
+    return settlement;
+  }
+
+private:
+  date settlement;
+  vector<double> coupons;
+  vector<date> maturities;
+  vector<CouponSchedule> schedules;
+  vector<BondAnalytics> analytics;
+
+  void BuildSchedules() {
+    schedules.clear();
+    schedules.reserve(maturities.size());
+    for (uint32_t i = 0; i < maturities.size(); ++i) {
+      schedules.push_back(BuildCouponSchedule(maturities[i], settlement));
+    }
+  }
+
+};
+
+#endif
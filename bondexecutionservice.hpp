@@ -5,56 +5,46 @@
 #ifndef BOND_EXECUTION_SERVICE_HPP
 #define BOND_EXECUTION_SERVICE_HPP
 #include <string>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
-#include <thread>
 #include "soa.hpp"
+#include "socketpublisher.hpp"
+#include "wireformat.hpp"
+#include <atomic>
 #include "products.hpp"
 #include "bondalgoexecutionservice.hpp"
 #include "executionservice.hpp"
 #include "tradebookingservice.hpp"
+#include "securitymaster.hpp"
+#include <optional>
 using namespace std;
 
 // Connector to publish executions via socket
 class BondExecutionServiceConnector : public Connector<ExecutionOrder<Bond>> {
 private:
-    int socketFd;
-    bool running;
-    int port;
-    vector<int> clientSockets;  // Store connected clients
+    SocketPublisher publisher;
+    WireFormat format;
+    std::atomic<uint64_t> sequence;
 
 public:
-    BondExecutionServiceConnector(int _port) : port(_port) {
-        // Create socket
-        socketFd = socket(AF_INET, SOCK_STREAM, 0);
-        if (socketFd < 0) {
-            perror("Socket creation failed");
-            exit(1);
-        }
-
-        // Configure server address
-        sockaddr_in serverAddr{};
-        serverAddr.sin_family = AF_INET;
-        serverAddr.sin_port = htons(port);
-        serverAddr.sin_addr.s_addr = INADDR_ANY;
-
-        // Bind socket
-        if (::bind(socketFd, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
-            perror("Bind failed");
-            exit(1);
-        }
+    // Executions go to every client on the port; a client that falls behind is disconnected rather than sent a gapped feed
+    BondExecutionServiceConnector(int port, WireFormat _format = TEXT_WIRE) :
+        publisher(port, Config()), format(_format), sequence(0) {}
 
-        // Listen for connections
-        if (listen(socketFd, 5) < 0) {
-            perror("Listen failed");
-            exit(1);
+    void Publish(ExecutionOrder<Bond>& data) override {
+        if (format == BINARY_WIRE) {
+            ExecutionMessage message;
+            message.sequence = sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+            message.productIndex = SecurityMaster::Get().IndexOf(data.GetProduct());
+            message.side = data.GetSide() == BID ? 0 : 1;
+            message.orderType = data.GetOrderType();
+            message.orderId = data.GetOrderNumber();
+            message.price = data.GetPrice().Ticks();
+            message.visibleQuantity = data.GetVisibleQuantity();
+            message.hiddenQuantity = data.GetHiddenQuantity();
+            char buffer[ExecutionMessage::LENGTH];
+            publisher.Publish(string(buffer, EncodeExecution(message, buffer)));
+            return;
         }
 
-        running = true;
-    }
-
-    void Publish(ExecutionOrder<Bond>& data) override {
         string orderType = "";
         if (data.GetOrderType() == MARKET) {
             orderType = "MARKET";
@@ -71,42 +61,16 @@ public:
                     data.GetOrderId() + "," +
                     orderType + "," +
                     side + "," +
-                    to_string(data.GetPrice()) + "," + 
+                    to_string(data.GetPrice().ToDecimal()) + "," + 
                     to_string(data.GetVisibleQuantity()) + "\n";
-
-        // Non-blocking check for new connections
-        fd_set readSet;
-        struct timeval timeout{0, 0};  // Non-blocking
-        FD_ZERO(&readSet);
-        FD_SET(socketFd, &readSet);
-        
-        if (select(socketFd + 1, &readSet, nullptr, nullptr, &timeout) > 0) {
-            sockaddr_in clientAddr{};
-            socklen_t clientLen = sizeof(clientAddr);
-            int clientFd = accept(socketFd, (sockaddr*)&clientAddr, &clientLen);
-            if (clientFd >= 0) {
-                clientSockets.push_back(clientFd);
-            }
-        }
-
-        // Send to all connected clients
-        auto it = clientSockets.begin();
-        while (it != clientSockets.end()) {
-            if (send(*it, msg.c_str(), msg.length(), MSG_NOSIGNAL) < 0) {
-                close(*it);
-                it = clientSockets.erase(it);  // Remove disconnected client
-            } else {
-                ++it;
-            }
-        }
+        publisher.Publish(std::move(msg));
     }
 
-    ~BondExecutionServiceConnector() {
-        running = false;
-        for (int clientFd : clientSockets) {
-            close(clientFd);
-        }
-        close(socketFd);
+private:
+    static PublisherConfig Config() {
+        PublisherConfig config;
+        config.policy = DISCONNECT;
+        return config;
     }
 };
 
@@ -134,7 +98,7 @@ public:
  */
 class BondExecutionService : public ExecutionService<Bond> {
 private:
-    map<string, ExecutionOrder<Bond>> executionOrders;
+    vector<std::optional<ExecutionOrder<Bond>>> executionOrders;  // by product index
     vector<ServiceListener<ExecutionOrder<Bond>>*> listeners;
     BondExecutionServiceConnector* connector;
     BondExecutionServiceListener* listener;
@@ -142,8 +106,9 @@ private:
     //int orderIDs = 1;
 
 public:
-    BondExecutionService(BondAlgoExecutionService* algoExecutionService, BondMarketDataService* _marketDataService) {
-        connector = new BondExecutionServiceConnector(3000);  // Use port 3000 for streaming
+    BondExecutionService(BondAlgoExecutionService* algoExecutionService, BondMarketDataService* _marketDataService, WireFormat format = TEXT_WIRE) :
+        executionOrders(SecurityMaster::Get().Size()) {
+        connector = new BondExecutionServiceConnector(3000, format);  // Use port 3000 for streaming
         listener = new BondExecutionServiceListener(this);
         algoExecutionService->AddListener(listener);
         marketDataService = _marketDataService;
@@ -155,15 +120,18 @@ public:
 
     // Get data on our service given a key
     ExecutionOrder<Bond>& GetData(string key) override {
-        return executionOrders.find(key)->second;
+        uint32_t index = SecurityMaster::Get().Find(key);
+        if (index == ProductRegistry::NOT_FOUND || !executionOrders[index]) {
+            throw std::runtime_error("ExecutionOrder not found for key: " + key);
+        }
+        return *executionOrders[index];
     }
 
     void ExecuteOrder(const ExecutionOrder<Bond>& order, Market market) override {}
 
     // The callback that a Connector should invoke for any new or updated data
     void OnMessage(ExecutionOrder<Bond>& data) override {
-        string productId = data.GetProduct().GetProductId();
-        executionOrders.insert_or_assign(productId, data);
+        executionOrders[SecurityMaster::Get().IndexOf(data.GetProduct())] = data;
         connector->Publish(data);
         // Notify all listeners
         for (auto& listener : listeners) {
@@ -5,6 +5,7 @@
 #include "historicaldataservice.hpp"
 #include "products.hpp"
 #include "filewriterconnector.hpp"
+#include "timestampformatter.hpp"
 #include "positionservice.hpp"
 #include <chrono>
 #include <iomanip>
@@ -18,14 +19,9 @@ class BondHistoricalDataServiceListener : public ServiceListener<T> {
     public:
         BondHistoricalDataServiceListener(HistoricalDataService<T>* service) : service(service) {}
         void ProcessAdd(T& data) override {
-            auto now = chrono::system_clock::now();
-            auto time_now = chrono::system_clock::to_time_t(now);
-            auto ms_part = chrono::duration_cast<chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
-            stringstream ss;
-            ss << put_time(localtime(&time_now), "%H:%M:%S") << "."
-               << setfill('0') << setw(3) << ms_part;
-            string timestamp = ss.str();
-            service->PersistData(timestamp, data);
+            char timestamp[TimestampFormatter::MAX_LENGTH];
+            size_t length = TimestampFormatter::Format(timestamp);
+            service->PersistData(string(timestamp, length), data);
         }
         void ProcessRemove(T& data) override {}
         void ProcessUpdate(T& data) override {}
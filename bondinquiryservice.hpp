@@ -1,7 +1,6 @@
 #include "inquiryservice.hpp"
 #include "products.hpp"
 #include "soa.hpp"
-#include "inquirysocketreaderconnector.hpp"
 
 #ifndef BONDINQUIRYSERVICE_HPP
 #define BONDINQUIRYSERVICE_HPP
@@ -11,10 +10,10 @@ class BondInquiryService : public InquiryService<Bond> {
 private:
     std::map<std::string, Inquiry<Bond>*> inquiries;
     std::vector<ServiceListener<Inquiry<Bond>>*> listeners;
-    InquirySocketReaderConnector* clientConnector;
+    Connector<Inquiry<Bond>>* clientConnector;
 
 public:
-    BondInquiryService() {}
+    BondInquiryService() : clientConnector(nullptr) {}
 
     void OnMessage(Inquiry<Bond>& data) override {
        inquiries[data.GetInquiryId()] = &data;
@@ -23,14 +22,18 @@ public:
         }
         //ADD IN THE PRICE AND SEND BACCK TO CONNECTOR
         if (data.GetState() == InquiryState::RECEIVED) {
-            SendQuote(data.GetInquiryId(), 100.0);
+            SendQuote(data.GetInquiryId(), TreasuryPrice::FromPoints(100));
         }
     }   
 
-    void SendQuote(const string &inquiryId, double price) override {
+    void SendQuote(const string &inquiryId, TreasuryPrice price) override {
         Inquiry<Bond>& inquiry = *inquiries[inquiryId];
         inquiry.SetPrice(price);
-        clientConnector->ReceiveQuote(inquiry);
+        // The client connector publishes the quote back and the client accepts it
+        inquiry.ChangeState(InquiryState::QUOTED);
+        clientConnector->Publish(inquiry);
+        inquiry.ChangeState(InquiryState::DONE);
+        clientConnector->Publish(inquiry);
     }
 
     void RejectInquiry(const string &inquiryId) override {}
@@ -44,7 +47,7 @@ public:
         }
     }
 
-    void AddClientConnector(InquirySocketReaderConnector* connector) {
+    void AddClientConnector(Connector<Inquiry<Bond>>* connector) {
         clientConnector = connector;
     }
 
@@ -6,47 +6,70 @@
 #include "soa.hpp"
 #include "marketdataservice.hpp"
 #include "products.hpp"
+#include "securitymaster.hpp"
 
 
 class BondMarketDataService : public MarketDataService<Bond>
 {
 private:
-    std::map<std::string, OrderBook<Bond>> orderbooks;
+    std::vector<OrderBook<Bond>> orderbooks;  // by product index, updated in place
+    std::vector<OrderBook<Bond>> aggregated;  // same-price levels merged, kept current on each update
     std::vector<ServiceListener<OrderBook<Bond>>*> listeners;
+
+    OrderBook<Bond>& FindOrderBook(const string &productId) {
+        uint32_t index = SecurityMaster::Get().Find(productId);
+        if (index == ProductRegistry::NOT_FOUND ||
+            (orderbooks[index].GetBidDepth() == 0 && orderbooks[index].GetOfferDepth() == 0)) {
+            throw std::runtime_error("Order book not found for product: " + productId);
+        }
+        return orderbooks[index];
+    }
+
+    // Rebuild the aggregated book from a raw book; at most MAX_DEPTH^2 compares per side
+    static void AggregateLevels(const OrderBook<Bond> &book, OrderBook<Bond> &aggregate) {
+        aggregate.Clear();
+        BookLevels bids = book.GetBidLevels();
+        for (size_t i = 0; i < bids.size(); ++i) {
+            aggregate.MergeLevel(BID, bids.prices[i], bids.sizes[i]);
+        }
+        BookLevels offers = book.GetOfferLevels();
+        for (size_t i = 0; i < offers.size(); ++i) {
+            aggregate.MergeLevel(OFFER, offers.prices[i], offers.sizes[i]);
+        }
+    }
+
 public:
 
-    BondMarketDataService() {};
+    BondMarketDataService() {
+        orderbooks.reserve(SecurityMaster::Get().Size());
+        for (const Bond& bond : SecurityMaster::Get().GetBonds()) {
+            orderbooks.emplace_back(bond);
+        }
+        aggregated = orderbooks;
+    };
   
     // Get the best bid/offer order
     BidOffer GetBestBidOffer(const string &productId) override {
-        auto it = orderbooks.find(productId);
-        if (it != orderbooks.end()) {
-            return BidOffer(it->second.GetBidStack()[0], it->second.GetOfferStack()[0]);
-        }
-        throw std::runtime_error("Order book not found for product: " + productId);
+        return FindOrderBook(productId).GetBestBidOffer();
     }
 
-    // Aggregate the order book
+    // Get the order book with quantity aggregated by price level
     const OrderBook<Bond>& AggregateDepth(const string &productId) override {
-        auto it = orderbooks.find(productId);
-        if (it != orderbooks.end()) {
-            return it->second;
-        }
-        throw std::runtime_error("Order book not found for product: " + productId);
+        const OrderBook<Bond>& orderbook = FindOrderBook(productId);
+        return aggregated[SecurityMaster::Get().IndexOf(orderbook.GetProduct())];
     }
 
     OrderBook<Bond>& GetData(string productId) override {
-        auto it = orderbooks.find(productId);
-        if (it != orderbooks.end()) {
-            return it->second;
-        }
-        throw std::runtime_error("Order book not found for product: " + productId);
+        return FindOrderBook(productId);
     }
     
     void OnMessage(OrderBook<Bond> &orderbook) override {
-        orderbooks.insert_or_assign(orderbook.GetProduct().GetProductId(), orderbook);
+        uint32_t index = SecurityMaster::Get().IndexOf(orderbook.GetProduct());
+        OrderBook<Bond>& book = orderbooks[index];
+        book = orderbook;
+        AggregateLevels(book, aggregated[index]);
         for (auto listener : listeners) {
-            listener->ProcessAdd(orderbook);
+            listener->ProcessAdd(book);
         }
     }
 
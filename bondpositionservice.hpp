@@ -1,29 +1,33 @@
 #include "products.hpp"
 #include "positionservice.hpp"
 #include "tradebookingservice.hpp"
+#include "securitymaster.hpp"
+#include "productlocks.hpp"
+#include "positiondelta.hpp"
+#include <optional>
+#include <mutex>
 
 
 #ifndef BOND_POSITION_SERVICE_HPP
 #define BOND_POSITION_SERVICE_HPP
 
-class BondPositionServiceListener : public ServiceListener<Trade<Bond>> {
+class BondPositionService;
+
+class BondPositionServiceListener : public ServiceListener<PositionDelta> {
 private:
-    PositionService<Bond>* service;
+    BondPositionService* service;
 
 public:
-    // Simplified constructor
-    BondPositionServiceListener(PositionService<Bond>& positionService) : service(&positionService) {}
+    BondPositionServiceListener(BondPositionService& positionService) : service(&positionService) {}
 
-    // Simplified ProcessAdd - just forwards to service
-    void ProcessAdd(Trade<Bond>& data) override {
-        service->AddTrade(data);
-    }
+    // Apply the position change of a booked trade
+    void ProcessAdd(PositionDelta& data) override;
 
     // Process a remove event to the Service
-    void ProcessRemove(Trade<Bond>& data) override {}
+    void ProcessRemove(PositionDelta& data) override {}
 
     // Process an update event to the Service
-    void ProcessUpdate(Trade<Bond>& data) override {}
+    void ProcessUpdate(PositionDelta& data) override {}
 
     ~BondPositionServiceListener() {}
 };
@@ -33,46 +37,53 @@ class BondPositionService : public PositionService<Bond>
 {
 private:
   BondPositionServiceListener* listener;
-  std::map<string, Position<Bond>>* positions;
+  std::vector<std::optional<Position<Bond>>> positions;  // by product index
+  ProductLocks locks;  // guards positions[i]; taken inside the trade booking lock
   vector<ServiceListener<Position<Bond>>*> listeners;
+  vector<ServiceListener<PositionDelta>*> deltaListeners;
   TradeBookingService<Bond>* tradeBookingService;
 public:
   //CREATE CONSTRUCTOR WITH BOND ID AND POSITION IN EACH BOOK
   BondPositionService(TradeBookingService<Bond>* _tradeBookingService) :
+    positions(SecurityMaster::Get().Size()),
+    locks(SecurityMaster::Get().Size()),
     tradeBookingService(_tradeBookingService)
   {
-    positions = new std::map<string, Position<Bond>>();
     listener = new BondPositionServiceListener(*this);
-    tradeBookingService->AddListener(listener);
+    tradeBookingService->AddDeltaListener(listener);
   }
   // Add a trade to the service
   void AddTrade(const Trade<Bond> &trade) override {
-    string productId = trade.GetProduct().GetProductId();
-    string book = trade.GetBook();
-    Side side = trade.GetSide();
-    long quantity = trade.GetQuantity();
-
-    // Check if position exists, if not create it with the product from the trade
-    if (positions->find(productId) == positions->end()) {
-        positions->insert({productId, Position<Bond>(trade.GetProduct())});
+    long quantity = trade.GetSide() == BUY ? trade.GetQuantity() : -trade.GetQuantity();
+    PositionDelta delta{SecurityMaster::Get().IndexOf(trade.GetProduct()), trade.GetBookId(), quantity, 0};
+    ApplyDelta(delta);
+  }
+
+  // Apply one book's position change, then pass the delta, with the new
+  // aggregate, to delta listeners and the full position to position listeners
+  void ApplyDelta(PositionDelta &delta) {
+    lock_guard<mutex> guard(locks[delta.productIndex]);
+    std::optional<Position<Bond>>& position = positions[delta.productIndex];
+    if (!position) {
+      position.emplace(SecurityMaster::Get().GetBond(delta.productIndex));
     }
+    position->AddPosition(delta.book, delta.quantityChange);
+    delta.aggregatePosition = position->GetAggregatePosition();
 
-    if (side == BUY) {
-      positions->at(productId).AddPosition(book, quantity);
-    } else {
-      positions->at(productId).AddPosition(book, -quantity);
+    for (auto& listener : deltaListeners) {
+      listener->ProcessAdd(delta);
     }
     for (auto& listener : listeners) {
-            listener->ProcessAdd(positions->at(productId));
-        }
-  };
-  
+      listener->ProcessAdd(*position);
+    }
+  }
+
   void OnMessage(Position<Bond>& data) override {}
 
   Position<Bond>& GetPosition(const string& productId) {
-    auto it = positions->find(productId);
-    if (it != positions->end()) {    
-      return it->second;
+    uint32_t index = SecurityMaster::Get().Find(productId);
+    if (index != ProductRegistry::NOT_FOUND && positions[index]) {    
+      return *positions[index];
     }
     throw std::runtime_error("Position not found for productId: " + productId);
   }
@@ -84,14 +95,22 @@ public:
     return listeners;
   }
 
+  // Add a listener for position changes, called under the product's lock
+  void AddDeltaListener(ServiceListener<PositionDelta>* listener) {
+    deltaListeners.push_back(listener);
+  }
+
   Position<Bond>& GetData(string key) override {
     return GetPosition(key);
   }
 
   ~BondPositionService() {
-    delete positions;
     delete listener;
   }
 };
 
+inline void BondPositionServiceListener::ProcessAdd(PositionDelta& data) {
+    service->ApplyDelta(data);
+}
+
 #endif
\ No newline at end of file
@@ -1,17 +1,35 @@
 #include "soa.hpp"
 #include "pricingservice.hpp"
 #include "products.hpp"
+#include "securitymaster.hpp"
+#include "staticdispatch.hpp"
 #include <iostream>
 
 #ifndef BONDPRICINGSERVICE_HPP
 #define BONDPRICINGSERVICE_HPP
 
-class BondPricingService : public Service<string,Price<Bond> > {
+/**
+ * Pricing service for bonds.
+ * StaticListeners is a StaticListenerList of listeners wired at compile time;
+ * they are called before any listeners added with AddListener.
+ */
+template<typename StaticListeners = NoStaticListeners<Price<Bond>>>
+class BasicBondPricingService : public Service<string,Price<Bond> > {
 public:
-    BondPricingService() {}
+    BasicBondPricingService() : received(SecurityMaster::Get().Size(), 0) {
+        const ProductRegistry &registry = SecurityMaster::Get();
+        prices.reserve(registry.Size());
+        for (uint32_t index = 0; index < registry.Size(); ++index) {
+            prices.emplace_back(registry.GetBond(index), TreasuryPrice(), TreasuryPrice());
+        }
+    }
 
     void OnMessage(Price<Bond>& data) override {
-        prices[data.GetProduct().GetProductId()] = &data;
+        // Keep a copy: data belongs to the connector and does not outlive this call
+        uint32_t index = SecurityMaster::Get().IndexOf(data.GetProduct());
+        prices[index] = data;
+        received[index] = 1;
+        staticListeners.ProcessAdd(data);
         for (auto listener : listeners) {
             listener->ProcessAdd(data);
         }
@@ -19,8 +37,9 @@ public:
     }
 
     Price<Bond>& GetData(string key) override {
-        if (prices.find(key) != prices.end()) {
-            return *prices[key];
+        uint32_t index = SecurityMaster::Get().Find(key);
+        if (index != ProductRegistry::NOT_FOUND && received[index]) {
+            return prices[index];
         }
         else {
             throw std::invalid_argument("Key not found");
@@ -35,11 +54,20 @@ public:
         return listeners;
     }
 
-    ~BondPricingService() {}
+    // Get the compile-time listener list, to bind it
+    StaticListeners& GetStaticListeners() {
+        return staticListeners;
+    }
+
+    ~BasicBondPricingService() {}
 
     private:
-        std::map<std::string, Price<Bond>*> prices;
+        std::vector<Price<Bond>> prices;  // latest price by product index
+        std::vector<uint8_t> received;
+        StaticListeners staticListeners;
         std::vector<ServiceListener<Price<Bond>>*> listeners;
 };
 
+typedef BasicBondPricingService<> BondPricingService;
+
 #endif
\ No newline at end of file
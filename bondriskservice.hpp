@@ -1,49 +1,23 @@
 #ifndef BOND_RISK_SERVICE_HPP
 #define BOND_RISK_SERVICE_HPP
 
-#include <cmath>
 #include "riskservice.hpp"
 #include "products.hpp"
 #include "positionservice.hpp"
 #include "soa.hpp"
 #include "bondpositionservice.hpp"
-#include "pricesocketreaderconnector.hpp"
+#include "securitymaster.hpp"
+#include "productlocks.hpp"
+#include "bondanalytics.hpp"
+#include "sectormap.hpp"
+#include "positiondelta.hpp"
+#include <optional>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 using namespace std;
 
-// Function to calculate bond price
-double calculatePrice(double couponRate, double yield, int timeToMaturity, double faceValue = 100) {
-    double price = 0.0;
-    int periods = timeToMaturity * 2; // Semi-annual periods
-    double semiAnnualYield = yield / 2;
-    double semiAnnualCoupon = couponRate * faceValue / 2;
-
-    // Sum of discounted coupon payments
-    for (int t = 1; t <= periods; ++t) {
-        price += semiAnnualCoupon / pow(1 + semiAnnualYield, t);
-    }
-
-    // Add discounted face value
-    price += faceValue / pow(1 + semiAnnualYield, periods);
-
-    return price;
-}
-
-// Function to calculate PV01 for a bond priced at 100, assuming yield = coupon rate
-double calculatePV01(double couponRate, int timeToMaturity) {
-    double faceValue = 100.0; // Bond priced at 100
-    double yield = couponRate; // Assume yield equals coupon rate
-
-    // Calculate the bond price at initial yield
-    double initialPrice = calculatePrice(couponRate, yield, timeToMaturity, faceValue);
-
-    // Adjust yield by 1 basis point (0.0001) and calculate new price
-    double newPrice = calculatePrice(couponRate, yield + 0.0001, timeToMaturity, faceValue);
-
-    // Calculate PV01 as the difference in price
-    return initialPrice - newPrice;
-}
-
 /*
 class BondPV01: public PV01<Bond> {
 public:
@@ -61,24 +35,22 @@ public:
 */
 
 
-class BondRiskServiceListener : public ServiceListener<Position<Bond>> {
+class BondRiskService;
+
+class BondRiskServiceListener : public ServiceListener<PositionDelta> {
 private:
-    RiskService<Bond>& bondRiskService;
+    BondRiskService& bondRiskService;
 
 public:
-    BondRiskServiceListener(RiskService<Bond>& service) : bondRiskService(service) {}
+    BondRiskServiceListener(BondRiskService& service) : bondRiskService(service) {}
 
-    void ProcessAdd(Position<Bond>& data) override {
-        bondRiskService.AddPosition(data);
-    }
+    void ProcessAdd(PositionDelta& data) override;
 
-    void ProcessRemove(Position<Bond>& data) override {
+    void ProcessRemove(PositionDelta& data) override {
         // No implementation needed
     }
 
-    void ProcessUpdate(Position<Bond>& data) override {
-        bondRiskService.AddPosition(data);
-    }
+    void ProcessUpdate(PositionDelta& data) override;
 };
 
 
@@ -87,12 +59,25 @@ class BondRiskService : public RiskService<Bond> {
     BondPositionService* bondPositionService;
     BondRiskServiceListener* listener;
     vector<ServiceListener<PV01<Bond>>*> listeners;
-    map<string, PV01<Bond>> risk;
-    map<string, double> pv01_lookup;
-
-    BondRiskService(BondPositionService* _bondPositionService) : bondPositionService(_bondPositionService) {
+    vector<std::optional<PV01<Bond>>> risk;  // by product index
+    BondAnalyticsTable analytics;  // DV01 by product index, repriced on curve moves
+    ProductLocks locks;  // guards risk[i] and analytics for product i; taken inside the position lock
+    std::unique_ptr<std::atomic<double>[]> riskTotals;  // PV01*quantity by product index, read lock-free by sector queries
+    SectorMap sectorMap;
+    std::unique_ptr<std::atomic<double>[]> sectorTotals;  // running PV01*quantity by sector, updated by delta
+
+    BondRiskService(BondPositionService* _bondPositionService, const string& sectorFile = "TSectors.csv") :
+        bondPositionService(_bondPositionService), risk(SecurityMaster::Get().Size()), analytics(SecurityMaster::Get(), SecurityMaster::GetSettlement(), SecurityMaster::GetPrecomputedAnalytics()),
+        locks(SecurityMaster::Get().Size()), riskTotals(new std::atomic<double>[SecurityMaster::Get().Size()]),
+        sectorMap(SecurityMaster::Get(), sectorFile), sectorTotals(new std::atomic<double>[sectorMap.SectorCount()]) {
+        for (size_t i = 0; i < SecurityMaster::Get().Size(); ++i) {
+            riskTotals[i].store(0.0, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < sectorMap.SectorCount(); ++i) {
+            sectorTotals[i].store(0.0, std::memory_order_relaxed);
+        }
         listener = new BondRiskServiceListener(*this);  
-        bondPositionService->AddListener(listener);
+        bondPositionService->AddDeltaListener(listener);
     }
 
     ~BondRiskService() {
@@ -102,23 +87,37 @@ class BondRiskService : public RiskService<Bond> {
     void OnMessage(PV01<Bond>& data) override {}
 
     PV01<Bond>& GetData(string key) override {
-        return risk.at(key);
+        uint32_t index = SecurityMaster::Get().Find(key);
+        if (index == ProductRegistry::NOT_FOUND || !risk[index]) {
+            throw std::out_of_range("Risk not found for product: " + key);
+        }
+        return *risk[index];
     }
 
     const PV01<Bond>& GetData(string key) const {
-        return risk.at(key);
+        uint32_t index = SecurityMaster::Get().Find(key);
+        if (index == ProductRegistry::NOT_FOUND || !risk[index]) {
+            throw std::out_of_range("Risk not found for product: " + key);
+        }
+        return *risk[index];
     }
 
     PV01<BucketedSector<Bond>> GetBucketedRisk(const BucketedSector<Bond>& sector) const override {
         double pv01 = 0.0;
         for (const auto& bond : sector.GetProducts()) {
-            if (risk.find(bond.GetProductId()) != risk.end()) {
-                PV01<Bond> pv01_obj = GetData(bond.GetProductId());
-                pv01 += pv01_obj.GetPV01()*pv01_obj.GetQuantity();
-            }
+            pv01 += riskTotals[SecurityMaster::Get().IndexOf(bond)].load(std::memory_order_acquire);
         }
-        BucketedSector<Bond> bucketedSector = sector;
-        return PV01<BucketedSector<Bond>>(bucketedSector, pv01, 1);
+        return PV01<BucketedSector<Bond>>(sector, pv01, 1);
+    }
+
+    // Get the sector assignment used for the running sector totals
+    const SectorMap& GetSectorMap() const {
+        return sectorMap;
+    }
+
+    // Get the current PV01*quantity of a sector
+    double GetSectorPV01(uint32_t sector) const {
+        return sectorTotals[sector].load(std::memory_order_acquire);
     }
 
     // Add a listener to the service
@@ -127,41 +126,75 @@ class BondRiskService : public RiskService<Bond> {
     }
 
     void AddPosition(Position<Bond>& position) override {
-        string productId = position.GetProduct().GetProductId();
-        long quantity = position.GetAggregatePosition();
-        double pv01 = getPV01(position.GetProduct());
-        
-        // Create BondPV01 object first
-        PV01<Bond> bondPv01(position.GetProduct(), pv01, quantity);
-        
-        // Use find and update pattern (works in all C++ versions)
-        auto it = risk.find(productId);
-        if (it != risk.end()) {
-            it->second = bondPv01;  // Update existing
-        } else {
-            risk.insert(std::make_pair(productId, bondPv01));  // Insert new
+        uint32_t productIndex = SecurityMaster::Get().IndexOf(position.GetProduct());
+        lock_guard<mutex> guard(locks[productIndex]);
+        SetQuantity(productIndex, position.GetAggregatePosition());
+    }
+
+    // Restate a product's risk at the aggregate carried by a position change
+    void ApplyPositionDelta(const PositionDelta& delta) {
+        lock_guard<mutex> guard(locks[delta.productIndex]);
+        SetQuantity(delta.productIndex, delta.aggregatePosition);
+    }
+
+    // Get the PV01 for a product; callers hold the product's lock
+    double getPV01(uint32_t productIndex){
+        return analytics.GetDV01(productIndex);
+    }
+
+    // Reprice a product after its yield moved and restate its risk at the new PV01
+    void OnCurveMove(uint32_t productIndex, double yield) {
+        lock_guard<mutex> guard(locks[productIndex]);
+        analytics.SetYield(productIndex, yield);
+        std::optional<PV01<Bond>>& bondPv01 = risk[productIndex];
+        if (bondPv01) {
+            bondPv01.emplace(bondPv01->GetProduct(), getPV01(productIndex), bondPv01->GetQuantity());
+            SetProductRisk(productIndex, bondPv01->GetTotalRisk());
         }
-        
+    }
+
+private:
+
+    // Price a product's new aggregate position and publish its PV01; callers hold the product's lock
+    void SetQuantity(uint32_t productIndex, long quantity) {
+        double pv01 = getPV01(productIndex);
+        std::optional<PV01<Bond>>& bondPv01 = risk[productIndex];
+        bondPv01.emplace(SecurityMaster::Get().GetBond(productIndex), pv01, quantity);
+        SetProductRisk(productIndex, pv01 * quantity);
+
         for (auto& listener : listeners) {
-            listener->ProcessAdd(risk.at(productId));
+            listener->ProcessAdd(*bondPv01);
         }
     }
 
-    double getPV01(const Bond& bond){
-        if (pv01_lookup.find(bond.GetProductId()) == pv01_lookup.end()) {
-            float coupon = bond.GetCoupon();
-            date maturity = bond.GetMaturityDate();
-            float time_to_maturity = maturity.year() - 2024;
-            float pv01 = calculatePV01(coupon, time_to_maturity);
-            pv01_lookup[bond.GetProductId()] = pv01;
+    // Store a product's risk and move its sector total by the change; callers hold the product's lock
+    void SetProductRisk(uint32_t productIndex, double totalRisk) {
+        double previous = riskTotals[productIndex].exchange(totalRisk, std::memory_order_acq_rel);
+        uint32_t sector = sectorMap.SectorOf(productIndex);
+        if (sector == SectorMap::NO_SECTOR) {
+            return;
+        }
+        // Other products in the sector update under their own locks
+        std::atomic<double>& sectorTotal = sectorTotals[sector];
+        double current = sectorTotal.load(std::memory_order_relaxed);
+        while (!sectorTotal.compare_exchange_weak(current, current + totalRisk - previous, std::memory_order_acq_rel)) {
         }
-        return pv01_lookup[bond.GetProductId()];
     }
 
+public:
+
 
     const vector<ServiceListener<PV01<Bond>>*>& GetListeners() const override {
         return listeners;
     }
 };
 
+inline void BondRiskServiceListener::ProcessAdd(PositionDelta& data) {
+    bondRiskService.ApplyPositionDelta(data);
+}
+
+inline void BondRiskServiceListener::ProcessUpdate(PositionDelta& data) {
+    bondRiskService.ApplyPositionDelta(data);
+}
+
 #endif // BOND_RISK_SERVICE_HPP
\ No newline at end of file
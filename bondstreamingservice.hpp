@@ -5,105 +5,74 @@
 #ifndef BOND_STREAMING_SERVICE_HPP
 #define BOND_STREAMING_SERVICE_HPP
 #include <string>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
-#include <thread>
 #include "soa.hpp"
+#include "socketpublisher.hpp"
+#include "wireformat.hpp"
+#include <atomic>
+#include <chrono>
 #include "products.hpp"
 #include "bondalgostreamingservice.hpp"
 #include "streamingservice.hpp"
+#include "securitymaster.hpp"
+#include "timestampformatter.hpp"
+#include <optional>
 using namespace std;
 
 // Connector to publish streams via socket
 class BondStreamingServiceConnector : public Connector<AlgoStream<Bond>> {
 private:
-    int socketFd;
-    bool running;
-    int port;
-    vector<int> clientSockets;  // Store connected clients
+    SocketPublisher publisher;
+    WireFormat format;
+    std::atomic<uint64_t> sequence;
 
 public:
-    BondStreamingServiceConnector(int _port) : port(_port) {
-        // Create socket
-        socketFd = socket(AF_INET, SOCK_STREAM, 0);
-        if (socketFd < 0) {
-            perror("Socket creation failed");
-            exit(1);
-        }
-
-        // Configure server address
-        sockaddr_in serverAddr{};
-        serverAddr.sin_family = AF_INET;
-        serverAddr.sin_port = htons(port);
-        serverAddr.sin_addr.s_addr = INADDR_ANY;
-
-        // Bind socket
-        if (::bind(socketFd, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
-            perror("Bind failed");
-            exit(1);
-        }
+    // Streams go to every client on the port; a slow client gets the latest stream per product
+    BondStreamingServiceConnector(int port, WireFormat _format = TEXT_WIRE) :
+        publisher(port, Config()), format(_format), sequence(0) {}
 
-        // Listen for connections
-        if (listen(socketFd, 5) < 0) {
-            perror("Listen failed");
-            exit(1);
+    void Publish(AlgoStream<Bond>& data) override {
+        uint32_t productIndex = SecurityMaster::Get().IndexOf(data.GetPriceStream().GetProduct());
+        if (format == BINARY_WIRE) {
+            const PriceStream<Bond>& stream = data.GetPriceStream();
+            StreamMessage message;
+            message.sequence = sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+            message.productIndex = productIndex;
+            message.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            message.bidPrice = stream.GetBidOrder().GetPrice().Ticks();
+            message.offerPrice = stream.GetOfferOrder().GetPrice().Ticks();
+            message.bidVisibleQuantity = stream.GetBidOrder().GetVisibleQuantity();
+            message.bidHiddenQuantity = stream.GetBidOrder().GetHiddenQuantity();
+            message.offerVisibleQuantity = stream.GetOfferOrder().GetVisibleQuantity();
+            message.offerHiddenQuantity = stream.GetOfferOrder().GetHiddenQuantity();
+            char buffer[StreamMessage::LENGTH];
+            publisher.Publish(string(buffer, EncodeStream(message, buffer)), productIndex);
+            return;
         }
 
-        running = true;
-    }
-
-    void Publish(AlgoStream<Bond>& data) override {
-        auto now = chrono::system_clock::now();
-        auto time_now = chrono::system_clock::to_time_t(now);
-        auto ms_part = chrono::duration_cast<chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+        char timestamp[TimestampFormatter::MAX_LENGTH];
+        size_t length = TimestampFormatter::Format(timestamp);
         
         stringstream ss;
-        ss << put_time(localtime(&time_now), "%H:%M:%S") << "."
-           << setfill('0') << setw(3) << ms_part << ","
+        ss.write(timestamp, length);
+        ss << ","
            << data.GetPriceStream().GetProduct().GetProductId() << ","
-           << data.GetPriceStream().GetBidOrder().GetPrice() << ","
-           << data.GetPriceStream().GetOfferOrder().GetPrice() << ","
+           << data.GetPriceStream().GetBidOrder().GetPrice().ToDecimal() << ","
+           << data.GetPriceStream().GetOfferOrder().GetPrice().ToDecimal() << ","
            << data.GetPriceStream().GetBidOrder().GetVisibleQuantity() << ","
            << data.GetPriceStream().GetBidOrder().GetHiddenQuantity() << ","
            << data.GetPriceStream().GetOfferOrder().GetVisibleQuantity() << ","
            << data.GetPriceStream().GetOfferOrder().GetHiddenQuantity() << "\n";
-           
-        string msg = ss.str();
-
-        // Non-blocking check for new connections
-        fd_set readSet;
-        struct timeval timeout{0, 0};  // Non-blocking
-        FD_ZERO(&readSet);
-        FD_SET(socketFd, &readSet);
-        
-        if (select(socketFd + 1, &readSet, nullptr, nullptr, &timeout) > 0) {
-            sockaddr_in clientAddr{};
-            socklen_t clientLen = sizeof(clientAddr);
-            int clientFd = accept(socketFd, (sockaddr*)&clientAddr, &clientLen);
-            if (clientFd >= 0) {
-                clientSockets.push_back(clientFd);
-            }
-        }
 
-        // Send to all connected clients
-        auto it = clientSockets.begin();
-        while (it != clientSockets.end()) {
-            if (send(*it, msg.c_str(), msg.length(), MSG_NOSIGNAL) < 0) {
-                close(*it);
-                it = clientSockets.erase(it);  // Remove disconnected client
-            } else {
-                ++it;
-            }
-        }
+        // Formatted once; the publisher shares the buffer across clients
+        publisher.Publish(ss.str(), productIndex);
     }
 
-    ~BondStreamingServiceConnector() {
-        running = false;
-        for (int clientFd : clientSockets) {
-            close(clientFd);
-        }
-        close(socketFd);
+private:
+    static PublisherConfig Config() {
+        PublisherConfig config;
+        config.policy = CONFLATE;
+        return config;
     }
 };
 
@@ -133,27 +102,31 @@ public:
  */
 class BondStreamingService : public Service<string, AlgoStream<Bond>> {
 private:
-    map<string, AlgoStream<Bond>> algoStreams;
+    vector<std::optional<AlgoStream<Bond>>> algoStreams;  // by product index
     vector<ServiceListener<AlgoStream<Bond>>*> listeners;
     BondStreamingServiceConnector* connector;
     BondStreamingServiceListener* listener;
 
 public:
-    BondStreamingService(BondAlgoStreamingService* algoStreamingService) {
-        connector = new BondStreamingServiceConnector(9000);  // Use port 9000 for streaming
+    BondStreamingService(BondAlgoStreamingService* algoStreamingService, WireFormat format = TEXT_WIRE) :
+        algoStreams(SecurityMaster::Get().Size()) {
+        connector = new BondStreamingServiceConnector(9000, format);  // Use port 9000 for streaming
         listener = new BondStreamingServiceListener(this);
         algoStreamingService->AddListener(listener);
     }
 
     // Get data on our service given a key
     AlgoStream<Bond>& GetData(string key) override {
-        return algoStreams.find(key)->second;
+        uint32_t index = SecurityMaster::Get().Find(key);
+        if (index == ProductRegistry::NOT_FOUND || !algoStreams[index]) {
+            throw std::runtime_error("AlgoStream not found for key: " + key);
+        }
+        return *algoStreams[index];
     }
 
     // The callback that a Connector should invoke for any new or updated data
     void OnMessage(AlgoStream<Bond>& data) override {
-        string productId = data.GetPriceStream().GetProduct().GetProductId();
-        algoStreams.insert_or_assign(productId, data);
+        algoStreams[SecurityMaster::Get().IndexOf(data.GetPriceStream().GetProduct())] = data;
         // Publish to Connector
         connector->Publish(data);
         // Notify all listeners
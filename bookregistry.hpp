@@ -0,0 +1,102 @@
+/**
+ * bookregistry.hpp
+ * Interns trading book names to small dense IDs, so positions can keep one
+ * slot per book instead of a map keyed by name.
+ */
+#ifndef BOOK_REGISTRY_HPP
+#define BOOK_REGISTRY_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+typedef uint32_t BookId;
+
+/**
+ * Process-wide table of book names, numbered 0..Count()-1 in order of first
+ * appearance. IDs are never reused or renamed, so lookups read the table
+ * without locking; only adding a new book takes the lock.
+ */
+class BookRegistry
+{
+
+public:
+
+  static constexpr uint32_t MAX_BOOKS = 16;
+  static constexpr BookId NO_BOOK = 0xFFFFFFFF;
+
+  // Get the ID of a book, assigning the next one if the book is new.
+  // Throws out_of_range if the book is new and MAX_BOOKS are already in use
+  static BookId Intern(std::string_view name) {
+    BookId id;
+    if (!TryIntern(name, id)) {
+      throw std::out_of_range("Too many books, cannot add " + std::string(name));
+    }
+    return id;
+  }
+
+  // As Intern, but returns false instead of throwing when the table is full;
+  // input connectors use it to reject a trade before it enters the pipeline
+  static bool TryIntern(std::string_view name, BookId &id) {
+    BookRegistry &registry = Instance();
+    id = registry.Lookup(name);
+    if (id != NO_BOOK) {
+      return true;
+    }
+    std::lock_guard<std::mutex> guard(registry.insertLock);
+    id = registry.Lookup(name);
+    if (id != NO_BOOK) {
+      return true;
+    }
+    uint32_t count = registry.count.load(std::memory_order_relaxed);
+    if (count == MAX_BOOKS) {
+      return false;
+    }
+    registry.names[count] = std::string(name);
+    registry.count.store(count + 1, std::memory_order_release);
+    id = count;
+    return true;
+  }
+
+  // Get the ID of a known book, or NO_BOOK
+  static BookId Find(std::string_view name) {
+    return Instance().Lookup(name);
+  }
+
+  // Get the name of a book ID returned by Intern
+  static const std::string& Name(BookId id) {
+    return Instance().names[id];
+  }
+
+  // Number of books seen so far
+  static uint32_t Count() {
+    return Instance().count.load(std::memory_order_acquire);
+  }
+
+private:
+  std::array<std::string, MAX_BOOKS> names;
+  std::atomic<uint32_t> count{0};
+  std::mutex insertLock;
+
+  static BookRegistry& Instance() {
+    static BookRegistry registry;
+    return registry;
+  }
+
+  BookId Lookup(std::string_view name) const {
+    uint32_t known = count.load(std::memory_order_acquire);
+    for (uint32_t id = 0; id < known; ++id) {
+      if (names[id] == name) {
+        return id;
+      }
+    }
+    return NO_BOOK;
+  }
+
+};
+
+#endif
@@ -0,0 +1,385 @@
+/**
+ * eventbus.hpp
+ * Optional queued dispatch between Services and ServiceListeners.
+ * A queued stage owns a bounded lock-free queue and a worker thread, so the
+ * thread that publishes an event only pays for a copy onto the queue and the
+ * downstream work runs on the stage's own (optionally pinned) core.
+ */
+#ifndef EVENT_BUS_HPP
+#define EVENT_BUS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include "soa.hpp"
+#include "lockfreequeue.hpp"
+#include "timestampformatter.hpp"
+
+// Kind of event carried through a queued stage
+enum QueuedEventType { EVENT_ADD, EVENT_REMOVE, EVENT_UPDATE, EVENT_MESSAGE };
+
+/**
+ * Back-pressure statistics for one queued stage.
+ */
+struct StageStats
+{
+  size_t enqueued;
+  size_t processed;
+  size_t highWaterMark;   // most events seen waiting in the queue
+  size_t blockedPushes;   // pushes that found the queue full and had to wait
+  size_t capacity;
+  uint64_t handoffTicks;  // TscClock ticks from enqueue to dispatch, summed over events
+  uint64_t maxHandoffTicks;
+};
+
+/**
+ * Type-independent handle the EventBus uses to drain, stop and report on stages.
+ */
+class QueuedStageBase
+{
+
+public:
+
+  virtual ~QueuedStageBase() {}
+
+  // Stop the worker once the queue is empty and join it
+  virtual void Stop() = 0;
+
+  // True when every event enqueued so far has been processed
+  virtual bool Idle() const = 0;
+
+  // Total events enqueued so far
+  virtual size_t Enqueued() const = 0;
+
+  virtual StageStats GetStats() const = 0;
+
+  virtual const string& GetName() const = 0;
+
+};
+
+/**
+ * Worker thread and queue shared by the queued listener and service adapters.
+ * Type V is the event data type; events are copied onto the queue.
+ */
+template<typename V>
+class QueuedStage : public QueuedStageBase
+{
+
+public:
+
+  QueuedStage(const string &_name, size_t capacity, int _cpu) :
+    name(_name), queue(capacity), cpu(_cpu), stopping(false),
+    enqueued(0), processed(0), highWaterMark(0), blockedPushes(0), handoffTicks(0), maxHandoffTicks(0)
+  {
+  }
+
+  ~QueuedStage() override {
+    Stop();
+  }
+
+  void Stop() override {
+    stopping.store(true, std::memory_order_release);
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+  bool Idle() const override {
+    return processed.load(std::memory_order_acquire) == enqueued.load(std::memory_order_acquire);
+  }
+
+  size_t Enqueued() const override {
+    return enqueued.load(std::memory_order_acquire);
+  }
+
+  StageStats GetStats() const override {
+    return StageStats{enqueued.load(), processed.load(), highWaterMark.load(), blockedPushes.load(), queue.Capacity(),
+                      handoffTicks.load(), maxHandoffTicks.load()};
+  }
+
+  const string& GetName() const override {
+    return name;
+  }
+
+protected:
+
+  struct Event {
+    QueuedEventType type;
+    V data;
+    uint64_t enqueuedAt;
+    Event(QueuedEventType _type, const V &_data) : type(_type), data(_data), enqueuedAt(TscClock::Now()) {}
+  };
+
+  // Run one event on the worker thread
+  virtual void Dispatch(QueuedEventType type, V &data) = 0;
+
+  // Start the worker; called by the most derived constructor once Dispatch is usable
+  void Start() {
+    worker = std::thread(&QueuedStage::Run, this);
+    if (cpu >= 0) {
+      cpu_set_t cpuSet;
+      CPU_ZERO(&cpuSet);
+      CPU_SET(cpu, &cpuSet);
+      int error = pthread_setaffinity_np(worker.native_handle(), sizeof(cpu_set_t), &cpuSet);
+      if (error != 0) {
+        cerr << "Failed to pin stage " << name << " to cpu " << cpu << ": error " << error << endl;
+      }
+    }
+  }
+
+  // Copy an event onto the queue, waiting for space if the stage is behind
+  void Enqueue(QueuedEventType type, const V &data) {
+    enqueued.fetch_add(1, std::memory_order_acq_rel);
+    if (!queue.TryPush(type, data)) {
+      blockedPushes.fetch_add(1, std::memory_order_relaxed);
+      while (!queue.TryPush(type, data)) {
+        std::this_thread::yield();
+      }
+    }
+    size_t depth = queue.Size();
+    size_t mark = highWaterMark.load(std::memory_order_relaxed);
+    while (depth > mark && !highWaterMark.compare_exchange_weak(mark, depth, std::memory_order_relaxed)) {
+    }
+  }
+
+private:
+  string name;
+  MpscQueue<Event> queue;
+  int cpu;
+  std::thread worker;
+  std::atomic<bool> stopping;
+  std::atomic<size_t> enqueued;
+  std::atomic<size_t> processed;
+  std::atomic<size_t> highWaterMark;
+  std::atomic<size_t> blockedPushes;
+  std::atomic<uint64_t> handoffTicks;
+  std::atomic<uint64_t> maxHandoffTicks;
+
+  void Run() {
+    unsigned idleSpins = 0;
+    while (true) {
+      bool consumed = queue.TryConsume([this](Event &event) {
+        // Counters on different cores can be slightly out of step, so clamp at zero.
+        // Only the worker writes these, so plain load and store is enough
+        uint64_t now = TscClock::Now();
+        uint64_t handoff = now > event.enqueuedAt ? now - event.enqueuedAt : 0;
+        handoffTicks.store(handoffTicks.load(std::memory_order_relaxed) + handoff, std::memory_order_relaxed);
+        if (handoff > maxHandoffTicks.load(std::memory_order_relaxed)) {
+          maxHandoffTicks.store(handoff, std::memory_order_relaxed);
+        }
+        try {
+          Dispatch(event.type, event.data);
+        }
+        catch (const std::exception& e) {
+          cerr << "Error in stage " << name << ": " << e.what() << endl;
+        }
+      });
+      if (consumed) {
+        processed.fetch_add(1, std::memory_order_acq_rel);
+        idleSpins = 0;
+        continue;
+      }
+      if (stopping.load(std::memory_order_acquire) && Idle()) {
+        break;
+      }
+      // Spin briefly for the next event before backing off to a short sleep
+      if (++idleSpins < 1000) {
+        std::this_thread::yield();
+      }
+      else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+    }
+  }
+
+};
+
+/**
+ * ServiceListener that queues each callback and runs it on the wrapped
+ * listener from the stage's worker thread.
+ */
+template<typename V>
+class QueuedServiceListener : public ServiceListener<V>, public QueuedStage<V>
+{
+
+public:
+
+  QueuedServiceListener(const string &name, ServiceListener<V> *_listener, size_t capacity, int cpu) :
+    QueuedStage<V>(name, capacity, cpu), listener(_listener)
+  {
+    this->Start();
+  }
+
+  ~QueuedServiceListener() override {
+    this->Stop();
+  }
+
+  void ProcessAdd(V &data) override { this->Enqueue(EVENT_ADD, data); }
+  void ProcessRemove(V &data) override { this->Enqueue(EVENT_REMOVE, data); }
+  void ProcessUpdate(V &data) override { this->Enqueue(EVENT_UPDATE, data); }
+
+protected:
+
+  void Dispatch(QueuedEventType type, V &data) override {
+    if (type == EVENT_ADD) listener->ProcessAdd(data);
+    else if (type == EVENT_REMOVE) listener->ProcessRemove(data);
+    else listener->ProcessUpdate(data);
+  }
+
+private:
+  ServiceListener<V> *listener;
+
+};
+
+/**
+ * Service front that queues OnMessage and runs it on the wrapped service from
+ * the stage's worker thread. Connectors publish to the front so the socket
+ * thread only parses; everything else is forwarded to the wrapped service.
+ */
+template<typename K, typename V>
+class QueuedService : public Service<K,V>, public QueuedStage<V>
+{
+
+public:
+
+  QueuedService(const string &name, Service<K,V> *_service, size_t capacity, int cpu) :
+    QueuedStage<V>(name, capacity, cpu), service(_service)
+  {
+    this->Start();
+  }
+
+  ~QueuedService() override {
+    this->Stop();
+  }
+
+  V& GetData(K key) override { return service->GetData(key); }
+  void OnMessage(V &data) override { this->Enqueue(EVENT_MESSAGE, data); }
+  void AddListener(ServiceListener<V> *listener) override { service->AddListener(listener); }
+  const vector<ServiceListener<V>*>& GetListeners() const override { return service->GetListeners(); }
+
+protected:
+
+  void Dispatch(QueuedEventType, V &data) override {
+    service->OnMessage(data);
+  }
+
+private:
+  Service<K,V> *service;
+
+};
+
+/**
+ * Wires services and listeners either directly (the default) or through
+ * queued stages. Call Shutdown before the services it refers to are destroyed;
+ * it waits for every stage to drain, stops them and reports their statistics.
+ */
+class EventBus
+{
+
+public:
+
+  static const int NO_AFFINITY = -1;
+  static const size_t DEFAULT_CAPACITY = 4096;
+
+  // ctor for a bus that queues when enabled, optionally pinning each stage to its own cpu
+  EventBus(bool _queued, bool _pinStages = false, size_t _capacity = DEFAULT_CAPACITY) :
+    queued(_queued), pinStages(_pinStages), capacity(_capacity), nextCpu(1)
+  {
+  }
+
+  ~EventBus() {
+    Shutdown();
+  }
+
+  bool IsQueued() const {
+    return queued;
+  }
+
+  // Register listener on service, behind its own stage when queued
+  template<typename K, typename V>
+  void Subscribe(Service<K,V> &service, ServiceListener<V> *listener, const string &name) {
+    if (!queued) {
+      service.AddListener(listener);
+      return;
+    }
+    auto stage = std::make_unique<QueuedServiceListener<V>>(name, listener, capacity, AssignCpu());
+    service.AddListener(stage.get());
+    stages.push_back(std::move(stage));
+  }
+
+  // Get the service a connector should publish to: the service itself, or a queued front for it
+  template<typename K, typename V>
+  Service<K,V>* Front(Service<K,V> *service, const string &name) {
+    if (!queued) {
+      return service;
+    }
+    auto stage = std::make_unique<QueuedService<K,V>>(name, service, capacity, AssignCpu());
+    Service<K,V> *front = stage.get();
+    stages.push_back(std::move(stage));
+    return front;
+  }
+
+  // Wait until no stage has work left, then stop them all and print their statistics
+  void Shutdown() {
+    if (stages.empty()) {
+      return;
+    }
+    // A stage can feed another, so drain until a full pass sees no new events
+    size_t lastTotal = static_cast<size_t>(-1);
+    while (true) {
+      size_t total = 0;
+      bool idle = true;
+      for (auto &stage : stages) {
+        total += stage->Enqueued();
+        idle = idle && stage->Idle();
+      }
+      if (idle && total == lastTotal) {
+        break;
+      }
+      lastTotal = total;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (auto &stage : stages) {
+      stage->Stop();
+      StageStats stats = stage->GetStats();
+      cout << "Stage " << stage->GetName() << ": " << stats.processed << " events, queue high-water mark "
+           << stats.highWaterMark << "/" << stats.capacity << ", " << stats.blockedPushes << " blocked pushes";
+      if (stats.processed > 0) {
+        cout << ", handoff mean " << static_cast<uint64_t>(TscClock::ToNanoseconds(stats.handoffTicks) / stats.processed)
+             << " ns max " << static_cast<uint64_t>(TscClock::ToNanoseconds(stats.maxHandoffTicks)) << " ns";
+      }
+      cout << endl;
+    }
+    stages.clear();
+  }
+
+private:
+  bool queued;
+  bool pinStages;
+  size_t capacity;
+  int nextCpu;
+  vector<std::unique_ptr<QueuedStageBase>> stages;
+
+  // Next cpu round robin, leaving cpu 0 for the ingestion threads
+  int AssignCpu() {
+    if (!pinStages) {
+      return NO_AFFINITY;
+    }
+    int cpus = static_cast<int>(std::thread::hardware_concurrency());
+    if (cpus <= 1) {
+      return NO_AFFINITY;
+    }
+    int cpu = nextCpu;
+    nextCpu = nextCpu + 1 < cpus ? nextCpu + 1 : 1;
+    return cpu;
+  }
+
+};
+
+#endif
@@ -8,6 +8,8 @@
 #define EXECUTION_SERVICE_HPP
 
 #include <string>
+#include <cstdint>
+#include <cstdio>
 #include "soa.hpp"
 #include "marketdataservice.hpp"
 #include "helperfunction.hpp"
@@ -17,6 +19,16 @@ enum OrderType { FOK, IOC, MARKET, LIMIT, STOP };
 
 enum Market { BROKERTEC, ESPEED, CME };
 
+// Order IDs are kept as integers and only formatted, zero padded to 8 digits, when printed
+typedef uint64_t OrderId;
+
+static const size_t ORDER_ID_LENGTH = 24;
+
+// Format an order ID into out (at least ORDER_ID_LENGTH chars) and return its length
+inline size_t FormatOrderId(OrderId id, char* out) {
+  return snprintf(out, ORDER_ID_LENGTH, "%08llu", static_cast<unsigned long long>(id));
+}
+
 /**
  * An execution order that can be placed on an exchange.
  * Type T is the product type.
@@ -28,7 +40,7 @@ class ExecutionOrder
 public:
 
   // ctor for an order
-  ExecutionOrder(const T &_product, PricingSide _side, string _orderId, OrderType _orderType, double _price, double _visibleQuantity, double _hiddenQuantity, string _parentOrderId, bool _isChildOrder);
+  ExecutionOrder(const T &_product, PricingSide _side, OrderId _orderId, OrderType _orderType, TreasuryPrice _price, double _visibleQuantity, double _hiddenQuantity, OrderId _parentOrderId, bool _isChildOrder);
 
   // Get the product
   const T& GetProduct() const;
@@ -36,14 +48,17 @@ public:
   // Get the side
   PricingSide GetSide() const;
 
-  // Get the order ID
-  const string& GetOrderId() const;
+  // Get the order ID, formatted
+  string GetOrderId() const;
+
+  // Get the order ID as a number
+  OrderId GetOrderNumber() const;
 
   // Get the order type on this order
   OrderType GetOrderType() const;
 
   // Get the price on this order
-  double GetPrice() const;
+  TreasuryPrice GetPrice() const;
 
   // Get the visible quantity on this order
   long GetVisibleQuantity() const;
@@ -51,8 +66,8 @@ public:
   // Get the hidden quantity
   long GetHiddenQuantity() const;
  
-  // Get the parent order ID
-  const string& GetParentOrderId() const;
+  // Get the parent order ID, formatted
+  string GetParentOrderId() const;
 
   // Is child order?
   bool IsChildOrder() const;
@@ -60,14 +75,14 @@ public:
   string to_string() const;
 
 private:
-  T product;
+  const T* product;  // points into the product registry
   PricingSide side;
-  string orderId;
+  OrderId orderId;
   OrderType orderType;
-  double price;
+  TreasuryPrice price;
   double visibleQuantity;
   double hiddenQuantity;
-  string parentOrderId;
+  OrderId parentOrderId;
   bool isChildOrder;
 
 };
@@ -89,8 +104,8 @@ public:
 };
 
 template<typename T>
-ExecutionOrder<T>::ExecutionOrder(const T &_product, PricingSide _side, string _orderId, OrderType _orderType, double _price, double _visibleQuantity, double _hiddenQuantity, string _parentOrderId, bool _isChildOrder) :
-  product(_product)
+ExecutionOrder<T>::ExecutionOrder(const T &_product, PricingSide _side, OrderId _orderId, OrderType _orderType, TreasuryPrice _price, double _visibleQuantity, double _hiddenQuantity, OrderId _parentOrderId, bool _isChildOrder) :
+  product(&_product)
 {
   side = _side;
   orderId = _orderId;
@@ -105,7 +120,7 @@ ExecutionOrder<T>::ExecutionOrder(const T &_product, PricingSide _side, string _
 template<typename T>
 const T& ExecutionOrder<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
@@ -115,7 +130,14 @@ PricingSide ExecutionOrder<T>::GetSide() const
 }
 
 template<typename T>
-const string& ExecutionOrder<T>::GetOrderId() const
+string ExecutionOrder<T>::GetOrderId() const
+{
+  char buffer[ORDER_ID_LENGTH];
+  return string(buffer, FormatOrderId(orderId, buffer));
+}
+
+template<typename T>
+OrderId ExecutionOrder<T>::GetOrderNumber() const
 {
   return orderId;
 }
@@ -127,7 +149,7 @@ OrderType ExecutionOrder<T>::GetOrderType() const
 }
 
 template<typename T>
-double ExecutionOrder<T>::GetPrice() const
+TreasuryPrice ExecutionOrder<T>::GetPrice() const
 {
   return price;
 }
@@ -145,9 +167,10 @@ long ExecutionOrder<T>::GetHiddenQuantity() const
 }
 
 template<typename T>
-const string& ExecutionOrder<T>::GetParentOrderId() const
+string ExecutionOrder<T>::GetParentOrderId() const
 {
-  return parentOrderId;
+  char buffer[ORDER_ID_LENGTH];
+  return string(buffer, FormatOrderId(parentOrderId, buffer));
 }
 
 template<typename T>
@@ -159,11 +182,14 @@ bool ExecutionOrder<T>::IsChildOrder() const
 template<typename T>
 string ExecutionOrder<T>::to_string() const {
     std::stringstream ss;
-    
-
-    ss << product.GetProductId() << ", "
-    << (side == PricingSide::BID ? "Bid, " : "Offer, ")
-    << orderId << ", ";
+    char id[ORDER_ID_LENGTH];
+    size_t idLength = FormatOrderId(orderId, id);
+    char fractional[PRICE_FORMAT_LENGTH];
+    size_t fractionalLength = convert_to_fractional(price, fractional);
+
+    ss << product->GetProductId() << ", "
+    << (side == PricingSide::BID ? "Bid, " : "Offer, ");
+    ss.write(id, idLength) << ", ";
     switch (orderType) {
         case OrderType::FOK: ss << "FOK, "; break;
         case OrderType::IOC: ss << "IOC, "; break;
@@ -171,7 +197,7 @@ string ExecutionOrder<T>::to_string() const {
         case OrderType::LIMIT: ss << "LIMIT, "; break;
         case OrderType::STOP: ss << "STOP, "; break;
     }
-    ss << convert_to_fractional(price) << ", "
+    ss.write(fractional, fractionalLength) << ", "
        << visibleQuantity;
     return ss.str();
 }
@@ -0,0 +1,332 @@
+/**
+ * fieldparser.hpp
+ * Allocation-free parsers for the fields and records of our text feeds.
+ * Every parser works on a std::string_view into the caller's buffer and
+ * reports failures through a ParseError code rather than an exception.
+ */
+#ifndef FIELD_PARSER_HPP
+#define FIELD_PARSER_HPP
+
+#include <string_view>
+#include <cstddef>
+#include <limits>
+#include "marketdataservice.hpp"
+#include "tradebookingservice.hpp"
+#include "treasuryprice.hpp"
+
+enum ParseError { PARSE_OK, PARSE_TOO_SHORT, PARSE_MISSING_FIELD, PARSE_EXTRA_FIELD, PARSE_BAD_CUSIP, PARSE_BAD_PRICE, PARSE_BAD_NUMBER, PARSE_BAD_QUANTITY, PARSE_BAD_SIDE, PARSE_TOO_MANY_LEVELS, PARSE_UNKNOWN_CUSIP, PARSE_TOO_MANY_BOOKS };
+
+inline const char* ParseErrorString(ParseError error) {
+    switch (error) {
+        case PARSE_OK: return "OK";
+        case PARSE_TOO_SHORT: return "Input string too short";
+        case PARSE_MISSING_FIELD: return "Missing field";
+        case PARSE_EXTRA_FIELD: return "Unexpected trailing field";
+        case PARSE_BAD_CUSIP: return "Invalid CUSIP";
+        case PARSE_BAD_PRICE: return "Invalid fractional price";
+        case PARSE_BAD_NUMBER: return "Invalid number format";
+        case PARSE_BAD_QUANTITY: return "Invalid quantity";
+        case PARSE_BAD_SIDE: return "Invalid side";
+        case PARSE_TOO_MANY_LEVELS: return "Too many order book levels";
+        case PARSE_UNKNOWN_CUSIP: return "Unknown CUSIP";
+        case PARSE_TOO_MANY_BOOKS: return "Too many books";
+        default: return "Unknown parse error";
+    }
+}
+
+// Strip leading and trailing blanks from a field
+inline std::string_view TrimField(std::string_view field) {
+    size_t begin = 0;
+    size_t end = field.size();
+    while (begin < end && (field[begin] == ' ' || field[begin] == '\t')) {
+        begin++;
+    }
+    while (end > begin && (field[end - 1] == ' ' || field[end - 1] == '\t' || field[end - 1] == '\r')) {
+        end--;
+    }
+    return field.substr(begin, end - begin);
+}
+
+/**
+ * Walks the comma separated fields of a line in place.
+ */
+class FieldCursor
+{
+
+public:
+
+  FieldCursor(std::string_view _line) : line(_line), pos(0) {}
+
+  // Get the next trimmed field; false once the line is exhausted
+  bool Next(std::string_view &field) {
+    if (pos > line.size()) {
+      return false;
+    }
+    size_t comma = line.find(',', pos);
+    if (comma == std::string_view::npos) {
+      comma = line.size();
+    }
+    field = TrimField(line.substr(pos, comma - pos));
+    pos = comma + 1;
+    return true;
+  }
+
+  // Are there more fields left on the line?
+  bool HasMore() const {
+    return pos <= line.size();
+  }
+
+private:
+  std::string_view line;
+  size_t pos;
+
+};
+
+// Parse an unsigned run of decimal digits
+inline ParseError ParseUnsigned(std::string_view field, long &value) {
+    if (field.empty() || field.size() > 18) {
+        return PARSE_BAD_NUMBER;
+    }
+    long result = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9') {
+            return PARSE_BAD_NUMBER;
+        }
+        result = result * 10 + (c - '0');
+    }
+    value = result;
+    return PARSE_OK;
+}
+
+// Parse a plain decimal price such as "99" or "99.5"
+inline ParseError ParseDecimal(std::string_view field, double &value) {
+    size_t dot = field.find('.');
+    long whole = 0;
+    if (ParseUnsigned(field.substr(0, dot), whole) != PARSE_OK) {
+        return PARSE_BAD_NUMBER;
+    }
+    double result = whole;
+    if (dot != std::string_view::npos) {
+        std::string_view fraction = field.substr(dot + 1);
+        double scale = 0.1;
+        for (char c : fraction) {
+            if (c < '0' || c > '9') {
+                return PARSE_BAD_NUMBER;
+            }
+            result += (c - '0') * scale;
+            scale /= 10.0;
+        }
+    }
+    value = result;
+    return PARSE_OK;
+}
+
+// Parse a 9 character CUSIP (digits and upper case letters)
+inline ParseError ParseCusip(std::string_view field, std::string_view &cusip) {
+    if (field.size() != 9) {
+        return PARSE_BAD_CUSIP;
+    }
+    for (char c : field) {
+        if (!((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z'))) {
+            return PARSE_BAD_CUSIP;
+        }
+    }
+    cusip = field;
+    return PARSE_OK;
+}
+
+// Parse a Treasury fractional price "099-31+" into an exact TreasuryPrice
+inline ParseError ParseFractionalPrice(std::string_view field, TreasuryPrice &price) {
+    return TreasuryPrice::Parse(field, price) ? PARSE_OK : PARSE_BAD_PRICE;
+}
+
+// Parse a quantity, either plain ("500") or with a million/thousand suffix ("10M", "250K")
+inline ParseError ParseQuantity(std::string_view field, long &quantity) {
+    if (field.empty()) {
+        return PARSE_BAD_QUANTITY;
+    }
+    long multiplier = 1;
+    char suffix = field.back();
+    if (suffix == 'M' || suffix == 'm') {
+        multiplier = 1000000;
+        field.remove_suffix(1);
+    }
+    else if (suffix == 'K' || suffix == 'k') {
+        multiplier = 1000;
+        field.remove_suffix(1);
+    }
+    long value = 0;
+    // Eighteen digits fit a long, but not once scaled by the suffix
+    if (ParseUnsigned(field, value) != PARSE_OK || value > std::numeric_limits<long>::max() / multiplier) {
+        return PARSE_BAD_QUANTITY;
+    }
+    quantity = value * multiplier;
+    return PARSE_OK;
+}
+
+// Parse a market data side code (0 = BID, 1 = OFFER)
+inline ParseError ParsePricingSide(std::string_view field, PricingSide &side) {
+    if (field.size() != 1 || (field[0] != '0' && field[0] != '1')) {
+        return PARSE_BAD_SIDE;
+    }
+    side = field[0] == '0' ? BID : OFFER;
+    return PARSE_OK;
+}
+
+// Parse a trade side code (0 = BUY, 1 = SELL)
+inline ParseError ParseSide(std::string_view field, Side &side) {
+    if (field.size() != 1 || (field[0] != '0' && field[0] != '1')) {
+        return PARSE_BAD_SIDE;
+    }
+    side = field[0] == '0' ? BUY : SELL;
+    return PARSE_OK;
+}
+
+/**
+ * Parsed fields of a price line: "CUSIP, 099-000, 1"
+ * The spread is given in 1/128ths.
+ */
+struct PriceRecord
+{
+  std::string_view cusip;
+  TreasuryPrice mid;
+  TreasuryPrice bidOfferSpread;
+};
+
+/**
+ * One side/price/quantity level of a market data line.
+ */
+struct BookLevelRecord
+{
+  PricingSide side;
+  TreasuryPrice price;
+  long quantity;
+};
+
+/**
+ * Parsed fields of a market data line: "CUSIP, side, price, qty, side, price, qty, ..."
+ */
+struct OrderBookRecord
+{
+  static const size_t MAX_LEVELS = 32;
+
+  std::string_view cusip;
+  BookLevelRecord levels[MAX_LEVELS];
+  size_t levelCount;
+};
+
+/**
+ * Parsed fields of a trade line: "CUSIP, tradeId, price, book, quantity, side"
+ */
+struct TradeRecord
+{
+  std::string_view cusip;
+  std::string_view tradeId;
+  TreasuryPrice price;
+  std::string_view book;
+  long quantity;
+  Side side;
+};
+
+/**
+ * Parsed fields of an inquiry line: "inquiryId, CUSIP, side, quantity"
+ */
+struct InquiryRecord
+{
+  std::string_view inquiryId;
+  std::string_view cusip;
+  Side side;
+  long quantity;
+};
+
+// Parse a price stream line
+inline ParseError ParsePriceRecord(std::string_view line, PriceRecord &record) {
+    FieldCursor cursor(line);
+    std::string_view field;
+    if (!cursor.Next(field) || field.empty()) return PARSE_TOO_SHORT;
+    ParseError error = ParseCusip(field, record.cusip);
+    if (error != PARSE_OK) return error;
+    if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+    error = ParseFractionalPrice(field, record.mid);
+    if (error != PARSE_OK) return error;
+    if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+    long spread128 = 0;
+    if (ParseUnsigned(field, spread128) != PARSE_OK) return PARSE_BAD_NUMBER;
+    record.bidOfferSpread = TreasuryPrice::FromTicks(spread128 * 2);
+    if (cursor.HasMore()) return PARSE_EXTRA_FIELD;
+    return PARSE_OK;
+}
+
+// Parse a market data line
+inline ParseError ParseOrderBookRecord(std::string_view line, OrderBookRecord &record) {
+    FieldCursor cursor(line);
+    std::string_view field;
+    if (!cursor.Next(field) || field.empty()) return PARSE_TOO_SHORT;
+    ParseError error = ParseCusip(field, record.cusip);
+    if (error != PARSE_OK) return error;
+    record.levelCount = 0;
+    while (cursor.Next(field)) {
+        if (record.levelCount == OrderBookRecord::MAX_LEVELS) return PARSE_TOO_MANY_LEVELS;
+        BookLevelRecord &level = record.levels[record.levelCount];
+        error = ParsePricingSide(field, level.side);
+        if (error != PARSE_OK) return error;
+        if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+        error = ParseFractionalPrice(field, level.price);
+        if (error != PARSE_OK) return error;
+        if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+        error = ParseQuantity(field, level.quantity);
+        if (error != PARSE_OK) return error;
+        record.levelCount++;
+    }
+    return record.levelCount == 0 ? PARSE_TOO_SHORT : PARSE_OK;
+}
+
+// Parse a trade line. The price may be decimal ("99") or fractional ("99-16+")
+inline ParseError ParseTradeRecord(std::string_view line, TradeRecord &record) {
+    FieldCursor cursor(line);
+    std::string_view field;
+    if (!cursor.Next(field) || field.empty()) return PARSE_TOO_SHORT;
+    ParseError error = ParseCusip(field, record.cusip);
+    if (error != PARSE_OK) return error;
+    if (!cursor.Next(record.tradeId) || record.tradeId.empty()) return PARSE_MISSING_FIELD;
+    if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+    if (field.find('-') != std::string_view::npos) {
+        error = ParseFractionalPrice(field, record.price);
+    }
+    else {
+        // Decimal prices are rounded to the nearest 256th
+        double decimal = 0.0;
+        error = ParseDecimal(field, decimal);
+        record.price = TreasuryPrice::FromDecimal(decimal);
+    }
+    if (error != PARSE_OK) return error;
+    if (!cursor.Next(record.book) || record.book.empty()) return PARSE_MISSING_FIELD;
+    if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+    error = ParseQuantity(field, record.quantity);
+    if (error != PARSE_OK) return error;
+    if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+    error = ParseSide(field, record.side);
+    if (error != PARSE_OK) return error;
+    if (cursor.HasMore()) return PARSE_EXTRA_FIELD;
+    return PARSE_OK;
+}
+
+// Parse an inquiry line
+inline ParseError ParseInquiryRecord(std::string_view line, InquiryRecord &record) {
+    FieldCursor cursor(line);
+    if (!cursor.Next(record.inquiryId) || record.inquiryId.empty()) return PARSE_TOO_SHORT;
+    std::string_view field;
+    if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+    ParseError error = ParseCusip(field, record.cusip);
+    if (error != PARSE_OK) return error;
+    if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+    error = ParseSide(field, record.side);
+    if (error != PARSE_OK) return error;
+    if (!cursor.Next(field)) return PARSE_MISSING_FIELD;
+    error = ParseQuantity(field, record.quantity);
+    if (error != PARSE_OK) return error;
+    if (cursor.HasMore()) return PARSE_EXTRA_FIELD;
+    return PARSE_OK;
+}
+
+#endif
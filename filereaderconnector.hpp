@@ -8,10 +8,61 @@
 #include <cstring>
 #include <thread>
 #include <chrono>
+#include <functional>
+#include <string_view>
+#include <vector>
+#include <cerrno>
+#include <sys/uio.h>
+#include "soa.hpp"
 
 #ifndef FILEREADERCONNECTOR_HPP
 #define FILEREADERCONNECTOR_HPP
 
+// How fast a file is replayed to the socket
+enum ReplayMode { REPLAY_UNTHROTTLED, REPLAY_FIXED_RATE, REPLAY_TIMESTAMP_PACED };
+
+/**
+ * Replay settings for a FileReaderConnector.
+ * Lines are coalesced into sends of up to batchBytes; pacing only flushes early
+ * when the next line is not due yet.
+ */
+struct ReplayConfig
+{
+  // Extracts the original event time of a line; false if the line carries none
+  typedef std::function<bool(std::string_view, std::chrono::microseconds&)> TimestampExtractor;
+
+  ReplayMode mode = REPLAY_FIXED_RATE;
+  double messagesPerSecond = 1000.0;
+  size_t batchBytes = 64 * 1024;
+  TimestampExtractor timestampOf;
+
+  // Send the file as fast as the socket accepts it
+  static ReplayConfig Unthrottled(size_t batchBytes = 64 * 1024) {
+    ReplayConfig config;
+    config.mode = REPLAY_UNTHROTTLED;
+    config.batchBytes = batchBytes;
+    return config;
+  }
+
+  // Send a fixed number of lines per second
+  static ReplayConfig FixedRate(double messagesPerSecond, size_t batchBytes = 64 * 1024) {
+    ReplayConfig config;
+    config.mode = REPLAY_FIXED_RATE;
+    config.messagesPerSecond = messagesPerSecond;
+    config.batchBytes = batchBytes;
+    return config;
+  }
+
+  // Reproduce the spacing of the original timestamps in the file
+  static ReplayConfig TimestampPaced(TimestampExtractor timestampOf, size_t batchBytes = 64 * 1024) {
+    ReplayConfig config;
+    config.mode = REPLAY_TIMESTAMP_PACED;
+    config.timestampOf = timestampOf;
+    config.batchBytes = batchBytes;
+    return config;
+  }
+};
+
 class FileReaderConnector : public Connector<std::string> {
 private:
     std::string filename;
@@ -19,10 +70,97 @@ private:
     std::string targetIp;
     int targetPort;
     bool running;
+    ReplayConfig config;
+
+    // Write the whole buffer, retrying on partial sends
+    bool SendAll(const char* data, size_t length) {
+        while (length > 0) {
+            ssize_t sent = send(socketFd, data, length, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("Send failed");
+                return false;
+            }
+            data += sent;
+            length -= sent;
+        }
+        return true;
+    }
+
+    // Pass raw blocks of the file straight through; lines are already newline delimited
+    void ReplayUnthrottled(std::ifstream& file) {
+        std::vector<char> block(config.batchBytes);
+        char last = '\n';
+        while (running && file) {
+            file.read(block.data(), block.size());
+            std::streamsize count = file.gcount();
+            if (count <= 0) {
+                break;
+            }
+            last = block[count - 1];
+            if (!SendAll(block.data(), count)) {
+                return;
+            }
+        }
+        if (last != '\n') {
+            SendAll("\n", 1);
+        }
+    }
+
+    // Coalesce lines into batches and hold each line back until it is due
+    void ReplayPaced(std::ifstream& file) {
+        using namespace std::chrono;
+        std::string batch;
+        batch.reserve(config.batchBytes + 256);
+        std::string line;
+        const steady_clock::time_point start = steady_clock::now();
+        const double nanosPerMessage = config.messagesPerSecond > 0 ? 1e9 / config.messagesPerSecond : 0.0;
+        long messageCount = 0;
+        bool haveFirstTimestamp = false;
+        microseconds firstTimestamp(0);
+
+        while (running && std::getline(file, line)) {
+            steady_clock::time_point due = start;
+            if (config.mode == REPLAY_FIXED_RATE) {
+                due += nanoseconds(static_cast<long long>(messageCount * nanosPerMessage));
+            }
+            else if (config.timestampOf) {
+                microseconds timestamp;
+                if (config.timestampOf(line, timestamp)) {
+                    if (!haveFirstTimestamp) {
+                        firstTimestamp = timestamp;
+                        haveFirstTimestamp = true;
+                    }
+                    due += timestamp - firstTimestamp;
+                }
+            }
+            if (due > steady_clock::now()) {
+                if (!batch.empty() && !SendAll(batch.data(), batch.size())) {
+                    return;
+                }
+                batch.clear();
+                std::this_thread::sleep_until(due);
+            }
+            batch.append(line);
+            batch.push_back('\n');
+            messageCount++;
+            if (batch.size() >= config.batchBytes) {
+                if (!SendAll(batch.data(), batch.size())) {
+                    return;
+                }
+                batch.clear();
+            }
+        }
+        if (!batch.empty()) {
+            SendAll(batch.data(), batch.size());
+        }
+    }
 
 public:
-    FileReaderConnector(const std::string& file, const std::string& ip, int port)
-        : filename(file), targetIp(ip), targetPort(port), running(true) {
+    FileReaderConnector(const std::string& file, const std::string& ip, int port, const ReplayConfig& _config = ReplayConfig())
+        : filename(file), targetIp(ip), targetPort(port), running(true), config(_config) {
         // Create socket
         socketFd = socket(AF_INET, SOCK_STREAM, 0);
         if (socketFd < 0) {
@@ -43,8 +181,13 @@ public:
     }
 
     void Publish(std::string& data) override {
-        std::string message = data + "\n";
-        send(socketFd, message.c_str(), message.size(), 0);
+        char newline = '\n';
+        iovec parts[2];
+        parts[0].iov_base = const_cast<char*>(data.data());
+        parts[0].iov_len = data.size();
+        parts[1].iov_base = &newline;
+        parts[1].iov_len = 1;
+        writev(socketFd, parts, 2);
     }
 
     void Stop() {
@@ -55,20 +198,19 @@ public:
     }
 
     void ReadFromFileAndPublish() {
-        std::ifstream file(filename);
+        std::ifstream file(filename, std::ios::in | std::ios::binary);
         if (!file.is_open()) {
             std::cerr << "Failed to open file: " << filename << std::endl;
             return;
         }
 
-        std::string line;
-        while (running && std::getline(file, line)) {
-            //std::string time_str = line.substr(0,34);
-            //std::cerr << "Passing data: " << time_str << std::endl;
-            Publish(line);
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));  // Slow down for testing
+        if (config.mode == REPLAY_UNTHROTTLED) {
+            ReplayUnthrottled(file);
+        }
+        else {
+            ReplayPaced(file);
         }
-        
+
         Stop();
         file.close();
     }
@@ -78,4 +220,4 @@ public:
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -8,19 +8,160 @@
 #include <cstring>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include "soa.hpp"
+#include "lockfreequeue.hpp"
 
 #ifndef FILE_WRITER_CONNECTOR_HPP
 #define FILE_WRITER_CONNECTOR_HPP
 enum FileWriterConnectorType {POSITIONS, RISK, EXECUTIONS, STREAMING, INQUIRIES};
 
+/**
+ * When the background writer hands its buffer to the file.
+ * The buffer is written once it holds maxBufferedBytes, or once the oldest
+ * unwritten record is maxDelay old; with neither set it is only written at
+ * shutdown (or when it reaches the hard cap).
+ */
+struct FlushPolicy {
+    size_t maxBufferedBytes = 64 * 1024;
+    std::chrono::milliseconds maxDelay = std::chrono::milliseconds(100);
+
+    static FlushPolicy Bytes(size_t bytes) {
+        FlushPolicy policy;
+        policy.maxBufferedBytes = bytes;
+        policy.maxDelay = std::chrono::milliseconds::zero();
+        return policy;
+    }
+    static FlushPolicy Time(std::chrono::milliseconds delay) {
+        FlushPolicy policy;
+        policy.maxBufferedBytes = 0;
+        policy.maxDelay = delay;
+        return policy;
+    }
+    static FlushPolicy OnShutdown() {
+        FlushPolicy policy;
+        policy.maxBufferedBytes = 0;
+        policy.maxDelay = std::chrono::milliseconds::zero();
+        return policy;
+    }
+};
+
+/**
+ * Appends records to a file from a background writer thread.
+ * Publish moves the record onto an MPSC queue, so the listener threads that
+ * share a file publish without taking a lock; the writer drains it into one
+ * buffer and writes it according to the FlushPolicy. An idle writer parks on
+ * a condition variable and is woken by the next Publish, or when its buffer
+ * comes due under maxDelay.
+ */
 class FileWriterConnector : public Connector<std::string> {
 private:
+    static const size_t DEFAULT_QUEUE_CAPACITY = 16 * 1024;
+    static const size_t MAX_BUFFERED_BYTES = 4 * 1024 * 1024;  // hard cap for OnShutdown
+
     std::string filename;
     std::ofstream file;
+    FlushPolicy policy;
+    MpscQueue<std::string> queue;
+    std::mutex parkLock;
+    std::condition_variable wakeWriter;
+    std::atomic<bool> parked;  // writer is parked, or about to park, on wakeWriter
+    std::atomic<bool> stopping;
+    std::atomic<size_t> highWaterMark;
+    std::atomic<size_t> recordsWritten;
+    std::atomic<size_t> fullWaits;
+    std::thread writer;
+
+    static const unsigned IDLE_SPINS = 64;  // empty polls before the writer parks
+
+    void WriteLoop() {
+        std::string buffer;
+        buffer.reserve(policy.maxBufferedBytes > 0 ? policy.maxBufferedBytes + 4096 : 64 * 1024);
+        size_t hardCap = policy.maxBufferedBytes > 0 ? policy.maxBufferedBytes : MAX_BUFFERED_BYTES;
+        auto oldest = std::chrono::steady_clock::now();
+        size_t count = 0;
+        unsigned idleSpins = 0;
+        while (true) {
+            bool drained = true;
+            bool consumed = false;
+            while (queue.TryConsume([&](std::string& record) {
+                if (buffer.empty()) {
+                    oldest = std::chrono::steady_clock::now();
+                }
+                buffer.append(record);
+                buffer.push_back('\n');
+            })) {
+                count++;
+                consumed = true;
+                if (buffer.size() >= hardCap) {
+                    drained = false;
+                    break;
+                }
+            }
+            if (!buffer.empty()) {
+                bool due = buffer.size() >= hardCap ||
+                    (policy.maxDelay.count() > 0 && std::chrono::steady_clock::now() - oldest >= policy.maxDelay);
+                if (due) {
+                    WriteBuffer(buffer, count);
+                }
+            }
+            if (!drained || consumed) {
+                idleSpins = 0;
+                continue;
+            }
+            if (stopping.load(std::memory_order_acquire) && queue.Size() == 0) {
+                break;
+            }
+            if (++idleSpins < IDLE_SPINS) {
+                std::this_thread::yield();
+                continue;
+            }
+            idleSpins = 0;
+            Park(buffer.empty() || policy.maxDelay.count() == 0 ? nullptr : &oldest);
+        }
+        WriteBuffer(buffer, count);
+    }
+
+    // Sleep until a record is published, the writer is stopped, or the buffer
+    // started at oldest comes due; a null oldest waits without a deadline
+    void Park(const std::chrono::steady_clock::time_point* oldest) {
+        std::unique_lock<std::mutex> guard(parkLock);
+        parked.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in Publish: either the producer sees parked, or we see its record
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (queue.Size() == 0 && !stopping.load(std::memory_order_acquire)) {
+            if (oldest != nullptr) {
+                wakeWriter.wait_until(guard, *oldest + policy.maxDelay);
+            }
+            else {
+                wakeWriter.wait(guard);
+            }
+        }
+        parked.store(false, std::memory_order_relaxed);
+    }
+
+    void WakeWriter() {
+        { std::lock_guard<std::mutex> guard(parkLock); }
+        wakeWriter.notify_one();
+    }
+
+    void WriteBuffer(std::string& buffer, size_t& count) {
+        if (buffer.empty()) {
+            return;
+        }
+        file.write(buffer.data(), buffer.size());
+        file.flush();
+        buffer.clear();
+        recordsWritten.fetch_add(count, std::memory_order_relaxed);
+        count = 0;
+    }
 
 public:
-    FileWriterConnector(const std::string& filename_, FileWriterConnectorType type) : filename(filename_) {
+    FileWriterConnector(const std::string& filename_, FileWriterConnectorType type,
+                        const FlushPolicy& policy_ = FlushPolicy(), size_t queueCapacity = DEFAULT_QUEUE_CAPACITY)
+        : filename(filename_), policy(policy_), queue(queueCapacity), parked(false), stopping(false), highWaterMark(0), recordsWritten(0), fullWaits(0) {
         file.open(filename, std::ios::out | std::ios::app);
         if (type == POSITIONS) {
             file << "Timestamp, CUSIP, Book, Position, [Book], [Position], [Book], [Position], Aggregate, Position" << std::endl;
@@ -37,16 +178,51 @@ public:
         else if (type == INQUIRIES) {
             file << "Timestamp, CUSIP, InquiryId, Side, Quantity, Price, State" << std::endl;
         }
+        writer = std::thread(&FileWriterConnector::WriteLoop, this);
     }
 
+    // Queue the record for the writer thread from any thread; the contents of data are moved out
     void Publish(std::string& data) override {
-        file << data << std::endl;
+        if (!queue.TryPush(std::move(data))) {
+            fullWaits.fetch_add(1, std::memory_order_relaxed);
+            while (!queue.TryPush(std::move(data))) {
+                std::this_thread::yield();  // writer is behind; wait for space
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_relaxed)) {
+            WakeWriter();
+        }
+        size_t depth = queue.Size();
+        size_t mark = highWaterMark.load(std::memory_order_relaxed);
+        while (depth > mark && !highWaterMark.compare_exchange_weak(mark, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Largest number of records seen waiting in the queue
+    size_t GetHighWaterMark() const {
+        return highWaterMark.load(std::memory_order_relaxed);
     }
 
+    // Number of records written to the file so far
+    size_t GetRecordsWritten() const {
+        return recordsWritten.load(std::memory_order_relaxed);
+    }
 
     ~FileWriterConnector() {
+        stopping.store(true, std::memory_order_release);
+        WakeWriter();
+        if (writer.joinable()) {
+            writer.join();
+        }
         file.close();
+        // Only worth reporting if publishers had to wait for the writer, or nearly did
+        if (fullWaits.load(std::memory_order_relaxed) > 0 || GetHighWaterMark() * 4 >= queue.Capacity() * 3) {
+            std::cout << filename << ": " << GetRecordsWritten() << " records written, queue high-water mark "
+                      << GetHighWaterMark() << "/" << queue.Capacity() << ", " << fullWaits.load(std::memory_order_relaxed)
+                      << " waits on a full queue" << std::endl;
+        }
     }
 };
 
-#endif
\ No newline at end of file
+#endif
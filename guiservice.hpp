@@ -5,31 +5,36 @@
 #ifndef GUI_SERVICE_HPP
 #define GUI_SERVICE_HPP
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <thread>
 #include <fstream>
 #include "soa.hpp"
 #include "products.hpp"
+#include "securitymaster.hpp"
 #include "pricingservice.hpp"
 #include "bondpricingservice.hpp"
 #include <iomanip>
 #include "helperfunction.hpp"
+#include "timestampformatter.hpp"
+#include "productlocks.hpp"
 using namespace std;
 
 class GUIService;  // Forward declaration
 
 class GUIServiceListener : public ServiceListener<Price<Bond>> {
 private:
-    Service<string, Price<Bond>>* service;
+    GUIService* service;
 
 public:
     // Simplified constructor
-    GUIServiceListener(Service<string, Price<Bond>>& guiService) : service(&guiService) {}
+    GUIServiceListener(GUIService& guiService) : service(&guiService) {}
 
-    // Simplified ProcessAdd - just forwards to service
-    void ProcessAdd(Price<Bond>& data) override {
-        service->OnMessage(data);
-    }
+    // Simplified ProcessAdd - just forwards to service; defined after GUIService
+    void ProcessAdd(Price<Bond>& data) override;
 
     // Process a remove event to the Service
     void ProcessRemove(Price<Bond>& data) override {}
@@ -43,69 +48,88 @@ public:
 /**
  * GUI Service to throttle and display price updates.
  * Keyed on product identifier.
+ * Conflates prices: OnMessage only copies the latest price into the product's
+ * slot and marks it dirty, and a timer thread writes the rows that changed
+ * since the last snapshot once per interval. GUI output and listener calls are
+ * bounded by the interval however fast prices arrive.
  */
 class GUIService : public Service<string, Price<Bond>> {
+public:
+    static constexpr chrono::milliseconds DEFAULT_INTERVAL{300};
+
 private:
-    map<string, Price<Bond>*> prices;
+    vector<Price<Bond>> prices;   // latest price by product index, guarded by locks
+    vector<atomic<bool>> dirty;   // set when a price arrives, cleared when it is written
+    vector<uint8_t> received;     // guarded by locks, like prices
+    ProductLocks locks;
+    vector<Price<Bond>> changed;  // timer thread only
     vector<ServiceListener<Price<Bond>>*> listeners;
     GUIServiceListener* listener;
-    
-    // Move throttling-related members here
-    chrono::system_clock::time_point lastUpdate;
-    const chrono::milliseconds throttleInterval;
+
+    const chrono::milliseconds interval;
     int updateCount;
-    const int maxUpdates;
     ofstream outFile;
 
+    mutex timerLock;
+    condition_variable timerSignal;
+    bool stopping;
+    thread timer;
+
 public:
-    // Constructor with initialization of throttling members
-    GUIService(BondPricingService* bondPricingService) :
-        lastUpdate(chrono::system_clock::now()),
-        throttleInterval(30),
+    // Subscribes to the pricing service if given; otherwise wire GetListener() up yourself.
+    // Changed prices are written to gui.txt every interval
+    GUIService(Service<string, Price<Bond>>* bondPricingService = nullptr, chrono::milliseconds _interval = DEFAULT_INTERVAL) :
+        dirty(SecurityMaster::Get().Size()),
+        received(SecurityMaster::Get().Size(), 0),
+        locks(SecurityMaster::Get().Size()),
+        interval(_interval),
         updateCount(0),
-        maxUpdates(100) {
+        stopping(false) {
+        const ProductRegistry &registry = SecurityMaster::Get();
+        prices.reserve(registry.Size());
+        changed.reserve(registry.Size());
+        for (uint32_t index = 0; index < registry.Size(); ++index) {
+            prices.emplace_back(registry.GetBond(index), TreasuryPrice(), TreasuryPrice());
+        }
         listener = new GUIServiceListener(*this);
-        bondPricingService->AddListener(listener);
+        if (bondPricingService != nullptr) {
+            bondPricingService->AddListener(listener);
+        }
         outFile.open("gui.txt");
+        timer = thread(&GUIService::Run, this);
     }
 
-    // Get data on our service given a key
+    GUIService(const GUIService&) = delete;
+    GUIService& operator=(const GUIService&) = delete;
+
+    // Get data on our service given a key. Returns the calling thread's copy of
+    // the latest price, taken under the product's lock and valid until its next GetData call
     Price<Bond>& GetData(string key) override {
-        return *prices[key];
+        uint32_t index = SecurityMaster::Get().Find(key);
+        if (index == ProductRegistry::NOT_FOUND) {
+            throw std::invalid_argument("Key not found");
+        }
+        static thread_local optional<Price<Bond>> copy;
+        {
+            lock_guard<mutex> guard(locks[index]);
+            if (!received[index]) {
+                throw std::invalid_argument("Key not found");
+            }
+            copy = prices[index];
+        }
+        return *copy;
     }
 
     // The callback that a Connector should invoke for any new or updated data
     void OnMessage(Price<Bond>& data) override {
-        auto now = chrono::system_clock::now();
-        string productId = data.GetProduct().GetProductId();
-        prices[productId] = &data;
-        if (updateCount >= maxUpdates) return;
-        
-        if (now - lastUpdate >= throttleInterval) {
-            
-
-            // Get current time with millisecond precision
-            auto time_now = chrono::system_clock::to_time_t(now);
-            auto ms_part = chrono::duration_cast<chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
-            outFile << "Timestamp: " << put_time(localtime(&time_now), "%H:%M:%S") 
-                   << "." << setfill('0') << setw(3) << ms_part << " | "
-                   << "Price Update " << ++updateCount << ": " << endl; 
-            for (const auto& [productId, price] : prices) {
-                outFile << productId << " "
-                    << "Mid: " << convert_to_fractional(price->GetMid()) 
-                    << " Spread: " << convert_to_256th(price->GetBidOfferSpread()) << endl;
-            }
-            
-            lastUpdate += chrono::milliseconds(300);
-            
-            // Notify listeners
-            for (auto& l : listeners) {
-                l->ProcessAdd(*prices[productId]);
-            }
-        }
+        uint32_t productIndex = SecurityMaster::Get().IndexOf(data.GetProduct());
+        lock_guard<mutex> guard(locks[productIndex]);
+        prices[productIndex] = data;
+        received[productIndex] = 1;
+        dirty[productIndex].store(true, memory_order_release);
     }
 
-    // Add a listener to the Service
+    // Add a listener to the Service; it is called from the timer thread with each changed price
     void AddListener(ServiceListener<Price<Bond>>* listener) override {
         listeners.push_back(listener);
     }
@@ -115,13 +139,86 @@ public:
         return listeners;
     }
 
-    // Destructor
+    // Get the listener that feeds prices into this service
+    GUIServiceListener* GetListener() {
+        return listener;
+    }
+
+    // Destructor; writes whatever changed since the last snapshot
     ~GUIService() {
+        {
+            lock_guard<mutex> guard(timerLock);
+            stopping = true;
+        }
+        timerSignal.notify_one();
+        timer.join();
         delete listener;
         if (outFile.is_open()) {
             outFile.close();
         }
     }
+
+private:
+    // Write a snapshot every interval on a fixed schedule, skipping ticks missed while writing
+    void Run() {
+        unique_lock<mutex> guard(timerLock);
+        auto next = chrono::steady_clock::now() + interval;
+        while (!timerSignal.wait_until(guard, next, [this]() { return stopping; })) {
+            guard.unlock();
+            WriteSnapshot();
+            guard.lock();
+            next += interval;
+            auto now = chrono::steady_clock::now();
+            if (next <= now) {
+                next = now + interval;
+            }
+        }
+        guard.unlock();
+        WriteSnapshot();
+    }
+
+    // Write and publish the prices that changed since the last snapshot
+    void WriteSnapshot() {
+        changed.clear();
+        for (uint32_t index = 0; index < prices.size(); ++index) {
+            if (!dirty[index].load(memory_order_acquire)) {
+                continue;
+            }
+            lock_guard<mutex> guard(locks[index]);
+            dirty[index].store(false, memory_order_relaxed);
+            changed.push_back(prices[index]);
+        }
+        if (changed.empty()) {
+            return;
+        }
+
+        char timestamp[TimestampFormatter::MAX_LENGTH];
+        TimestampFormatter::Format(chrono::system_clock::now(), timestamp);
+        outFile << "Timestamp: " << timestamp << " | "
+               << "Price Update " << ++updateCount << ": " << '\n';
+        char mid[PRICE_FORMAT_LENGTH];
+        char spread[PRICE_FORMAT_LENGTH];
+        for (const Price<Bond>& price : changed) {
+            size_t midLength = convert_to_fractional(price.GetMid(), mid);
+            size_t spreadLength = convert_to_256th(price.GetBidOfferSpread(), spread);
+            outFile << price.GetProduct().GetProductId() << " Mid: ";
+            outFile.write(mid, midLength) << " Spread: ";
+            outFile.write(spread, spreadLength) << '\n';
+        }
+        outFile.flush();
+
+        // Notify listeners
+        for (Price<Bond>& price : changed) {
+            for (auto& l : listeners) {
+                l->ProcessAdd(price);
+            }
+        }
+    }
 };
 
+// Qualified so the call binds statically and inlines through the StaticListenerList
+inline void GUIServiceListener::ProcessAdd(Price<Bond>& data) {
+    service->GUIService::OnMessage(data);
+}
+
 #endif
@@ -1,24 +1,39 @@
+#include <charconv>
+#include <cstddef>
 #include <string>
-#include <sstream>
-#include <cmath>
-#include <iomanip>
+#include "treasuryprice.hpp"
 
 #ifndef HELPERFUNCTION_HPP
 #define HELPERFUNCTION_HPP
 
-std::string convert_to_fractional(double price){
-    std::stringstream converted_ss;
-    converted_ss << floor(price+0.0000001) << '-';
-    converted_ss << std::setw(2) << std::setfill('0') << (int)(((int) std::round(price * 256.0) % 256)/8);
-    int last_digit = (int)((int) std::round(price * 256.0)) % 8;
-    converted_ss << std::setw(1) << (last_digit == 4 ? "+" : std::to_string(last_digit));
-    return converted_ss.str();
+// Longest output of the char buffer formatters below
+static constexpr size_t PRICE_FORMAT_LENGTH = TreasuryPrice::MAX_LENGTH;
+
+// Write a price in fractional notation, e.g. 99-16+, to out and return its length
+inline size_t convert_to_fractional(TreasuryPrice price, char *out){
+    return price.Format(out);
+}
+
+// Write a price as a count of 256ths, e.g. 2/256, to out and return its length
+inline size_t convert_to_256th(TreasuryPrice price, char *out){
+    char *end = std::to_chars(out, out + PRICE_FORMAT_LENGTH - 4, price.Ticks()).ptr;
+    end[0] = '/';
+    end[1] = '2';
+    end[2] = '5';
+    end[3] = '6';
+    return end + 4 - out;
+}
+
+// Format a price in fractional notation, e.g. 99-16+
+inline std::string convert_to_fractional(TreasuryPrice price){
+    char buffer[PRICE_FORMAT_LENGTH];
+    return std::string(buffer, convert_to_fractional(price, buffer));
 }
 
-std::string convert_to_256th(double price){
-    std::stringstream converted_ss;
-    converted_ss << std::round(price * 256.0) << "/256";
-    return converted_ss.str();
+// Format a price as a count of 256ths, e.g. 2/256
+inline std::string convert_to_256th(TreasuryPrice price){
+    char buffer[PRICE_FORMAT_LENGTH];
+    return std::string(buffer, convert_to_256th(price, buffer));
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -24,7 +24,7 @@ class Inquiry
 public:
 
   // ctor for an inquiry
-  Inquiry(string _inquiryId, const T &_product, Side _side, long _quantity, double _price, InquiryState _state);
+  Inquiry(string _inquiryId, const T &_product, Side _side, long _quantity, TreasuryPrice _price, InquiryState _state);
 
   // Add copy constructor
   Inquiry(const Inquiry& other) : 
@@ -38,10 +38,10 @@ public:
   // Add default constructor
   Inquiry() : 
       inquiryId(""),
-      product(T()),
+      product(nullptr),
       side(BUY),
       quantity(0),
-      price(0.0),
+      price(),
       state(RECEIVED) {}
 
   // Get the inquiry ID
@@ -57,9 +57,9 @@ public:
   long GetQuantity() const;
 
   // Get the price that we have responded back with
-  double GetPrice() const;
+  TreasuryPrice GetPrice() const;
 
-  double SetPrice(double _price);
+  TreasuryPrice SetPrice(TreasuryPrice _price);
 
   double ChangeState(InquiryState _state);
 
@@ -70,10 +70,10 @@ public:
 
 private:
   string inquiryId;
-  T product;
+  const T* product;  // points into the product registry
   Side side;
   long quantity;
-  double price;
+  TreasuryPrice price;
   InquiryState state;
 
 };
@@ -90,7 +90,7 @@ class InquiryService : public Service<string,Inquiry <T> >
 public:
 
   // Send a quote back to the client
-  virtual void SendQuote(const string &inquiryId, double price) = 0;
+  virtual void SendQuote(const string &inquiryId, TreasuryPrice price) = 0;
 
   // Reject an inquiry from the client
   virtual void RejectInquiry(const string &inquiryId) = 0;
@@ -98,8 +98,8 @@ public:
 };
 
 template<typename T>
-Inquiry<T>::Inquiry(string _inquiryId, const T &_product, Side _side, long _quantity, double _price, InquiryState _state) :
-  product(_product)
+Inquiry<T>::Inquiry(string _inquiryId, const T &_product, Side _side, long _quantity, TreasuryPrice _price, InquiryState _state) :
+  product(&_product)
 {
   inquiryId = _inquiryId;
   side = _side;
@@ -117,7 +117,7 @@ const string& Inquiry<T>::GetInquiryId() const
 template<typename T>
 const T& Inquiry<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
@@ -133,13 +133,13 @@ long Inquiry<T>::GetQuantity() const
 }
 
 template<typename T>
-double Inquiry<T>::GetPrice() const
+TreasuryPrice Inquiry<T>::GetPrice() const
 {
   return price;
 }
 
 template<typename T>
-double Inquiry<T>::SetPrice(double _price) {
+TreasuryPrice Inquiry<T>::SetPrice(TreasuryPrice _price) {
     price = _price;
     return price;
 }
@@ -160,7 +160,7 @@ template<typename T>
 string Inquiry<T>::to_string() const{
   string sideString = side == Side::BUY ? "BUY" : "SELL";
   string stateString = state == RECEIVED ? "RECEIVED" : state == QUOTED ? "QUOTED" : state == DONE ? "DONE" : state == REJECTED ? "REJECTED" : state == CUSTOMER_REJECTED ? "CUSTOMER_REJECTED" : "UNKNOWN";
-  return product.GetProductId() + "," + inquiryId + "," + sideString + "," + std::to_string(quantity) + "," + convert_to_fractional(price) + "," + stateString;
+  return product->GetProductId() + "," + inquiryId + "," + sideString + "," + std::to_string(quantity) + "," + convert_to_fractional(price) + "," + stateString;
 }
 
 #endif
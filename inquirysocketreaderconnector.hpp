@@ -14,20 +14,40 @@
 #include "products.hpp"
 #include "pricesocketreaderconnector.hpp"
 #include "inquiryservice.hpp"
+#include "fieldparser.hpp"
+#include "lineframer.hpp"
 #ifndef INQUIRYSOCKETREADERCONNECTOR_HPP
 #define INQUIRYSOCKETREADERCONNECTOR_HPP
 
 
+// Parse a raw line into an Inquiry<Bond> object and publish it through the connector
+inline ParseError PublishInquiryLine(std::string_view line, Connector<Inquiry<Bond>>& connector) {
+    InquiryRecord record;
+    ParseError error = ParseInquiryRecord(line, record);
+    if (error != PARSE_OK) {
+        return error;
+    }
+
+    const Bond* bond = SecurityMaster::Get().FindBond(record.cusip);
+    if (bond == nullptr) {
+        return PARSE_UNKNOWN_CUSIP;
+    }
+
+    Inquiry<Bond> inquiry(std::string(record.inquiryId), *bond, record.side, record.quantity, TreasuryPrice(), InquiryState::RECEIVED);
+    connector.Publish(inquiry);
+    return PARSE_OK;
+}
+
 class InquirySocketReaderConnector : public Connector<Inquiry<Bond>> {
 private:
     int socketFd;
     InquiryService<Bond>* targetService;
-    std::map<std::string,long> quantityMap;
     bool running;
+    size_t receiveBufferSize;
 
 public:
-    InquirySocketReaderConnector(int port, InquiryService<Bond>* service) 
-        : targetService(service), running(true) {
+    InquirySocketReaderConnector(int port, InquiryService<Bond>* service, size_t _receiveBufferSize = LineFramer::DEFAULT_CAPACITY) 
+        : targetService(service), running(true), receiveBufferSize(_receiveBufferSize) {
         // Create socket
         socketFd = socket(AF_INET, SOCK_STREAM, 0);
         if (socketFd < 0) {
@@ -58,7 +78,6 @@ public:
             perror("Listen failed");
             exit(1);
         }
-        quantityMap = std::map<std::string,long>({{"10M",10000000},{"20M",20000000},{"30M",30000000},{"40M",40000000},{"50M",50000000}});
     }
 
     void Stop() {
@@ -82,33 +101,25 @@ public:
                 }
                 std::cerr << "Client connected!" << std::endl;
 
-                std::string accumulated;
-                char buffer[1024];
+                LineFramer framer(receiveBufferSize);
                 while (running) {
-                    int bytesRead = read(clientFd, buffer, sizeof(buffer) - 1);
+                    ssize_t bytesRead = framer.ReadFrom(clientFd);
                     if (bytesRead <= 0) {
                         std::cerr << "Connection closed or error (bytesRead: " << bytesRead << ")" << std::endl;
                         break;
                     }
-                    
-                    buffer[bytesRead] = '\0';
-                    accumulated += buffer;
-                    
-                    size_t pos;
-                    while ((pos = accumulated.find('\n')) != std::string::npos) {
-                        std::string line = accumulated.substr(0, pos);
-                        if (!line.empty() && line[line.length()-1] == '\r') {
-                            line = line.substr(0, line.length()-1);  // Remove \r if present
-                        }
+
+                    framer.ForEachLine([this](std::string_view line) {
                         try {
-                            Inquiry<Bond> inquiry_obj = MakeInquiry(line);
-                            Publish(inquiry_obj);
+                            ParseError error = PublishLine(line);
+                            if (error != PARSE_OK) {
+                                std::cerr << "Error processing line: " << ParseErrorString(error) << ": " << line << std::endl;
+                            }
                         }
                         catch (const std::exception& e) {
                             std::cerr << "Error processing line: " << e.what() << std::endl;
                         }
-                        accumulated = accumulated.substr(pos + 1);
-                    }
+                    });
                 }
                 std::cerr << "Client connection closed" << std::endl;
                 close(clientFd);
@@ -123,36 +134,9 @@ public:
         targetService->OnMessage(data);
     }
 
-    void ReceiveQuote(Inquiry<Bond>& data){
-        data.ChangeState(InquiryState::QUOTED);
-        Publish(data);
-        data.ChangeState(InquiryState::DONE);
-        Publish(data);
-    }
-
-    // Parse raw string into Price<Bond> object
-    Inquiry<Bond> MakeInquiry(std::string input) {
-        // First check if the string is long enough
-        if (input.length() < 25) {  
-            throw std::runtime_error("Input string too short: " + input);
-        }
-
-        try {
-            std::string inquiryId = input.substr(0, 6);
-            std::string cusip = input.substr(8, 9);
-            Side side = (Side)stoi(input.substr(19, 1));
-            long quantity = stoi(input.substr(22, 3));
-            if (bondMap.find(cusip) == bondMap.end()) {
-                throw std::runtime_error("Unknown CUSIP: " + cusip);
-            }
-            return Inquiry<Bond>(inquiryId, bondMap.find(cusip)->second, side, quantity, 0.0, InquiryState::RECEIVED);
-        }
-        catch (const std::out_of_range& e) {
-            throw std::runtime_error("Invalid string format: " + input);
-        }
-        catch (const std::invalid_argument& e) {
-            throw std::runtime_error("Invalid number format in: " + input);
-        }
+    // Parse a raw line into an Inquiry<Bond> object and publish it to the service
+    ParseError PublishLine(std::string_view line) {
+        return PublishInquiryLine(line, *this);
     }
 
     ~InquirySocketReaderConnector() {
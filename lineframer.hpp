@@ -0,0 +1,93 @@
+/**
+ * lineframer.hpp
+ * Splits a byte stream read from a socket into newline terminated lines.
+ */
+#ifndef LINE_FRAMER_HPP
+#define LINE_FRAMER_HPP
+
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+
+/**
+ * Receive buffer that frames lines in place.
+ * Each read appends to the free tail of the buffer, complete lines are handed
+ * out as string_views into the buffer, and the unfinished tail is moved back
+ * to the front once per read. Lines longer than the buffer grow it.
+ */
+class LineFramer
+{
+
+public:
+
+  static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+  // ctor for a framer with the given receive buffer size
+  LineFramer(size_t capacity = DEFAULT_CAPACITY) :
+    buffer(capacity < 2 ? 2 : capacity), begin(0), end(0), scanned(0)
+  {
+  }
+
+  // Read once from the file descriptor into the free space; returns the read() result
+  ssize_t ReadFrom(int fd) {
+    if (end == buffer.size()) {
+      // Buffer holds a single partial line larger than the buffer
+      buffer.resize(buffer.size() * 2);
+    }
+    ssize_t bytesRead = read(fd, buffer.data() + end, buffer.size() - end);
+    if (bytesRead > 0) {
+      end += bytesRead;
+    }
+    return bytesRead;
+  }
+
+  // Hand each complete line (without its \r\n) to onLine, then compact the remainder
+  template<typename F>
+  void ForEachLine(F &&onLine) {
+    char *data = buffer.data();
+    while (scanned < end) {
+      char *newline = static_cast<char*>(memchr(data + scanned, '\n', end - scanned));
+      if (newline == nullptr) {
+        scanned = end;
+        break;
+      }
+      size_t pos = newline - data;
+      size_t length = pos - begin;
+      if (length > 0 && data[pos - 1] == '\r') {
+        length--;  // Remove \r if present
+      }
+      onLine(std::string_view(data + begin, length));
+      begin = pos + 1;
+      scanned = begin;
+    }
+    Compact();
+  }
+
+  // Number of bytes of an unfinished line waiting for more input
+  size_t Pending() const {
+    return end - begin;
+  }
+
+private:
+  std::vector<char> buffer;
+  size_t begin;
+  size_t end;
+  size_t scanned;
+
+  void Compact() {
+    if (begin == 0) {
+      return;
+    }
+    size_t pending = end - begin;
+    if (pending > 0) {
+      memmove(buffer.data(), buffer.data() + begin, pending);
+    }
+    scanned -= begin;
+    begin = 0;
+    end = pending;
+  }
+
+};
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * lockfreequeue.hpp
+ * Bounded lock-free queues for handing objects between threads.
+ */
+#ifndef LOCK_FREE_QUEUE_HPP
+#define LOCK_FREE_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Single-producer single-consumer ring buffer.
+ * Capacity is rounded up to a power of two. The producer and consumer
+ * indices live on separate cache lines, and each side keeps a cached copy of
+ * the other's index so it only touches the shared line when it looks full/empty.
+ * Type T is the element type; it must be default constructible and movable.
+ */
+template<typename T>
+class SpscQueue
+{
+
+public:
+
+  // ctor for a queue holding at least the given number of elements
+  explicit SpscQueue(size_t capacity) :
+    head(0), cachedTail(0), tail(0), cachedHead(0)
+  {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    slots.resize(size);
+    mask = size - 1;
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Move an element onto the queue; producer thread only. Returns false if full
+  bool TryPush(T &&item) {
+    size_t currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail - cachedHead == slots.size()) {
+      cachedHead = head.load(std::memory_order_acquire);
+      if (currentTail - cachedHead == slots.size()) {
+        return false;
+      }
+    }
+    slots[currentTail & mask] = std::move(item);
+    tail.store(currentTail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Move the oldest element off the queue; consumer thread only. Returns false if empty
+  bool TryPop(T &item) {
+    size_t currentHead = head.load(std::memory_order_relaxed);
+    if (currentHead == cachedTail) {
+      cachedTail = tail.load(std::memory_order_acquire);
+      if (currentHead == cachedTail) {
+        return false;
+      }
+    }
+    item = std::move(slots[currentHead & mask]);
+    head.store(currentHead + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate number of queued elements; exact from the producer or consumer thread
+  size_t Size() const {
+    size_t currentHead = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - currentHead;
+  }
+
+  // Maximum number of queued elements
+  size_t Capacity() const {
+    return slots.size();
+  }
+
+private:
+  std::vector<T> slots;
+  size_t mask;
+  alignas(64) std::atomic<size_t> head;  // next slot to pop, written by the consumer
+  size_t cachedTail;                     // consumer's copy of tail
+  alignas(64) std::atomic<size_t> tail;  // next slot to push, written by the producer
+  size_t cachedHead;                     // producer's copy of head
+
+};
+
+/**
+ * Multi-producer single-consumer ring buffer (Vyukov's bounded queue).
+ * Each cell carries a sequence number that tells producers whether it is free
+ * and the consumer whether it is filled, so producers only contend on the
+ * enqueue index. Elements are constructed in place and consumed in place, so
+ * T needs neither a default constructor nor assignment.
+ */
+template<typename T>
+class MpscQueue
+{
+
+public:
+
+  // ctor for a queue holding at least the given number of elements
+  explicit MpscQueue(size_t capacity) :
+    enqueuePos(0), dequeuePos(0)
+  {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    cells = std::vector<Cell>(size);
+    for (size_t i = 0; i < size; ++i) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask = size - 1;
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  ~MpscQueue() {
+    while (TryConsume([](T&) {})) {
+    }
+  }
+
+  // Construct an element at the tail from the arguments; any thread. Returns false if full
+  template<typename... Args>
+  bool TryPush(Args&&... args) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells[pos & mask];
+      size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (difference == 0) {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      }
+      else if (difference < 0) {
+        return false;
+      }
+      else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    new (&cell->storage) T(std::forward<Args>(args)...);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Hand the oldest element to consume and then destroy it; consumer thread only.
+  // Returns false if empty
+  template<typename F>
+  bool TryConsume(F &&consume) {
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell &cell = cells[pos & mask];
+    if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+      return false;
+    }
+    T *item = reinterpret_cast<T*>(&cell.storage);
+    consume(*item);
+    item->~T();
+    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate number of queued elements
+  size_t Size() const {
+    size_t currentDequeue = dequeuePos.load(std::memory_order_acquire);
+    size_t currentEnqueue = enqueuePos.load(std::memory_order_acquire);
+    return currentEnqueue > currentDequeue ? currentEnqueue - currentDequeue : 0;
+  }
+
+  // Maximum number of queued elements
+  size_t Capacity() const {
+    return cells.size();
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  std::vector<Cell> cells;
+  size_t mask;
+  alignas(64) std::atomic<size_t> enqueuePos;  // claimed by producers
+  alignas(64) std::atomic<size_t> dequeuePos;  // advanced by the consumer
+
+};
+
+#endif
@@ -27,66 +27,129 @@
 #include "marketdatasocketreaderconnector.hpp"
 #include "tradesocketreaderconnector.hpp"
 #include "bondriskhistoricaldataservice.hpp"
+#include "inquirysocketreaderconnector.hpp"
+#include "mmapfileconnector.hpp"
+#include "eventbus.hpp"
+#include "staticdispatch.hpp"
 #include <fstream>
 #include <sstream>
 #include <vector>
 #include <map>
 #include <boost/date_time/gregorian/gregorian.hpp>
 
-int main() {
+int main(int argc, char* argv[]) {
+
+    // --mmap replays the input files straight into the services instead of over the loopback sockets
+    // --queued runs each input pipeline and each historical writer on its own stage thread
+    // --pin additionally pins every stage thread to its own cpu
+    // --binary-streams / --binary-executions publish the port 9000 / 3000 feeds in the binary wire format
+    // --secmaster <file> loads the security master from file (CSV or snapshot) instead of TBonds.csv
+    bool directIngestion = false;
+    bool queuedDispatch = false;
+    bool pinStages = false;
+    WireFormat streamsFormat = TEXT_WIRE;
+    WireFormat executionsFormat = TEXT_WIRE;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--mmap") directIngestion = true;
+        else if (arg == "--queued") queuedDispatch = true;
+        else if (arg == "--pin") pinStages = true;
+        else if (arg == "--binary-streams") streamsFormat = BINARY_WIRE;
+        else if (arg == "--binary-executions") executionsFormat = BINARY_WIRE;
+        else if (arg == "--secmaster" && i + 1 < argc) SecurityMaster::SetSource(argv[++i]);
+        else std::cerr << "Unknown option: " << arg << std::endl;
+    }
 
     try {
 
         // Bond Price.txt Pipeline
         
-        BondPricingService bondPricingService;   
-        GUIService guiService(&bondPricingService);
-        BondAlgoStreamingService bondAlgoStreamingService(&bondPricingService);
-        BondStreamingService bondStreamingService(&bondAlgoStreamingService);
+        // The pricing fan-out is fixed, so it is resolved at compile time and inlined into OnMessage
+        typedef StaticListenerList<Price<Bond>, GUIServiceListener, BondAlgoStreamingServiceListener> PriceListeners;
+        BasicBondPricingService<PriceListeners> bondPricingService;
+        GUIService guiService;
+        BondAlgoStreamingService bondAlgoStreamingService;
+        bondPricingService.GetStaticListeners().Bind(guiService.GetListener(), bondAlgoStreamingService.GetListener());
+        BondStreamingService bondStreamingService(&bondAlgoStreamingService, streamsFormat);
         BondHistoricalDataService<AlgoStream<Bond>> bondStreamingHistoricalDataService("streaming.txt", STREAMING);
         BondHistoricalDataServiceListener<AlgoStream<Bond>> bondStreamingHistoricalDataServiceListener(&bondStreamingHistoricalDataService);
-        bondStreamingService.AddListener(&bondStreamingHistoricalDataServiceListener);
-        PricesSocketReaderConnector pricesSocketReader(8080, &bondPricingService);
-        pricesSocketReader.StartListening();
-        FileReaderConnector pricesFileReader("miniprices.txt", "127.0.0.1", 8080);
 
         // Bond Trade.txt Pipeline
         TradeBookingService<Bond> tradeBookingService;
         BondPositionService bondPositionService(&tradeBookingService);
         BondHistoricalDataService<Position<Bond>> bondPositionHistoricalDataService("positions.txt", POSITIONS);
         BondHistoricalDataServiceListener<Position<Bond>> bondPositionHistoricalDataServiceListener(&bondPositionHistoricalDataService);
-        bondPositionService.AddListener(&bondPositionHistoricalDataServiceListener);
         BondRiskService bondRiskService(&bondPositionService);
         BondRiskHistoricalDataService bondRiskHistoricalDataService("risk.txt", &bondRiskService);
         BondRiskHistoricalDataServiceListener bondRiskHistoricalDataServiceListener(&bondRiskHistoricalDataService);
-        bondRiskService.AddListener(&bondRiskHistoricalDataServiceListener);
-        TradesSocketReaderConnector tradeSocketReader(8081, &tradeBookingService);
-        tradeSocketReader.StartListening();
-        FileReaderConnector tradesFileReader("trades.txt", "127.0.0.1", 8081);    
 
-        
         // Bond MarketData.txt Pipeline with TradeBookingService
         BondMarketDataService bondMarketDataService;    
         BondAlgoExecutionService bondAlgoExecutionService(&bondMarketDataService);
-        BondExecutionService bondExecutionService(&bondAlgoExecutionService, &bondMarketDataService);
+        BondExecutionService bondExecutionService(&bondAlgoExecutionService, &bondMarketDataService, executionsFormat);
         BondHistoricalDataService<ExecutionOrder<Bond>> bondHistoricalDataService("executions.txt", EXECUTIONS);
         BondHistoricalDataServiceListener<ExecutionOrder<Bond>> bondHistoricalDataServiceListener(&bondHistoricalDataService);
-        bondExecutionService.AddListener(&bondHistoricalDataServiceListener);
         TradeBookingServiceListener<Bond> tradeBookingServiceListener(&tradeBookingService);
-        bondExecutionService.AddListener(&tradeBookingServiceListener);
-        MarketDataSocketReaderConnector marketDataSocketReader(8082, &bondMarketDataService);
+
+        // Bond Inquiries.txt Pipeline
+        BondInquiryService bondInquiryService;
+        BondHistoricalDataService<Inquiry<Bond>> bondInquiryHistoricalDataService("all_inquiries.txt", INQUIRIES);
+        BondHistoricalDataServiceListener<Inquiry<Bond>> bondInquiryHistoricalDataServiceListener(&bondInquiryHistoricalDataService);
+
+        // The bus is declared after every service and listener it dispatches to, so it is
+        // destroyed first: its stages drain and stop before anything they call is torn down
+        EventBus eventBus(queuedDispatch, pinStages);
+        eventBus.Subscribe(bondStreamingService, &bondStreamingHistoricalDataServiceListener, "streaming.txt");
+        eventBus.Subscribe(bondPositionService, &bondPositionHistoricalDataServiceListener, "positions.txt");
+        eventBus.Subscribe(bondRiskService, &bondRiskHistoricalDataServiceListener, "risk.txt");
+        eventBus.Subscribe(bondExecutionService, &bondHistoricalDataServiceListener, "executions.txt");
+        eventBus.Subscribe(bondInquiryService, &bondInquiryHistoricalDataServiceListener, "all_inquiries.txt");
+        bondExecutionService.AddListener(&tradeBookingServiceListener);  // executions are persisted before they are booked
+
+        // Services the input connectors publish to; queued fronts take parsing off the pipeline threads.
+        // Inquiries stay direct because the inquiry service quotes back through its connector.
+        Service<string, Price<Bond>>* pricesInput = eventBus.Front<string, Price<Bond>>(&bondPricingService, "prices");
+        Service<string, Trade<Bond>>* tradesInput = eventBus.Front<string, Trade<Bond>>(&tradeBookingService, "trades");
+        Service<string, OrderBook<Bond>>* marketDataInput = eventBus.Front<string, OrderBook<Bond>>(&bondMarketDataService, "market data");
+
+        if (directIngestion) {
+            // Map each input file and feed the services on its own thread
+            MmapFileConnector<Price<Bond>> pricesFile("miniprices.txt", pricesInput, PublishPriceLine);
+            MmapFileConnector<Trade<Bond>> tradesFile("trades.txt", tradesInput, PublishTradeLine);
+            MmapFileConnector<OrderBook<Bond>> marketDataFile("mini_market_data.txt", marketDataInput, PublishOrderBookLine);
+            MmapFileConnector<Inquiry<Bond>> inquiriesFile("inquiries.txt", &bondInquiryService, PublishInquiryLine);
+            bondInquiryService.AddClientConnector(&inquiriesFile);
+
+            std::thread pricesThread([&pricesFile]() { pricesFile.ReadFromFileAndPublish(); });
+            std::thread tradesThread([&tradesFile]() { tradesFile.ReadFromFileAndPublish(); });
+            std::thread marketDataThread([&marketDataFile]() { marketDataFile.ReadFromFileAndPublish(); });
+            std::thread inquiriesThread([&inquiriesFile]() { inquiriesFile.ReadFromFileAndPublish(); });
+
+            pricesThread.join();
+            tradesThread.join();
+            marketDataThread.join();
+            inquiriesThread.join();
+            eventBus.Shutdown();
+            return 0;
+        }
+
+        PricesSocketReaderConnector pricesSocketReader(8080, pricesInput);
+        pricesSocketReader.StartListening();
+        // The GUI conflates prices on its own timer, so prices replay as fast as the others
+        FileReaderConnector pricesFileReader("miniprices.txt", "127.0.0.1", 8080, ReplayConfig::Unthrottled());
+
+        TradesSocketReaderConnector tradeSocketReader(8081, tradesInput);
+        tradeSocketReader.StartListening();
+        FileReaderConnector tradesFileReader("trades.txt", "127.0.0.1", 8081, ReplayConfig::Unthrottled());    
+
+        MarketDataSocketReaderConnector marketDataSocketReader(8082, marketDataInput);
         marketDataSocketReader.StartListening();
-        FileReaderConnector marketDataFileReader("mini_market_data.txt", "127.0.0.1", 8082);
-        
-       
-       BondInquiryService bondInquiryService;
-       BondHistoricalDataService<Inquiry<Bond>> bondInquiryHistoricalDataService("all_inquiries.txt", INQUIRIES);
-       BondHistoricalDataServiceListener<Inquiry<Bond>> bondInquiryHistoricalDataServiceListener(&bondInquiryHistoricalDataService);
-       bondInquiryService.AddListener(&bondInquiryHistoricalDataServiceListener);
-       InquirySocketReaderConnector inquirySocketReader(8083, &bondInquiryService);
-       bondInquiryService.AddClientConnector(&inquirySocketReader);
-       inquirySocketReader.StartListening();
-       FileReaderConnector inquiriesFileReader("inquiries.txt", "127.0.0.1", 8083);
+        FileReaderConnector marketDataFileReader("mini_market_data.txt", "127.0.0.1", 8082, ReplayConfig::Unthrottled());
+
+        InquirySocketReaderConnector inquirySocketReader(8083, &bondInquiryService);
+        bondInquiryService.AddClientConnector(&inquirySocketReader);
+        inquirySocketReader.StartListening();
+        FileReaderConnector inquiriesFileReader("inquiries.txt", "127.0.0.1", 8083, ReplayConfig::Unthrottled());
        
         // Start file reading in a separate thread
         
@@ -156,6 +219,7 @@ int main() {
         //std::cout << "Press Enter to exit..." << std::endl;
         std::cin.get();
 
+        eventBus.Shutdown();
         return 0;
     }
     catch (const std::exception& e) {
@@ -9,7 +9,11 @@
 
 #include <string>
 #include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
 #include "soa.hpp"
+#include "treasuryprice.hpp"
 
 using namespace std;
 
@@ -25,10 +29,10 @@ class Order
 public:
 
   // ctor for an order
-  Order(double _price, long _quantity, PricingSide _side);
+  Order(TreasuryPrice _price, long _quantity, PricingSide _side);
 
   // Get the price on the order
-  double GetPrice() const;
+  TreasuryPrice GetPrice() const;
 
   // Get the quantity on the order
   long GetQuantity() const;
@@ -37,7 +41,7 @@ public:
   PricingSide GetSide() const;
 
 private:
-  double price;
+  TreasuryPrice price;
   long quantity;
   PricingSide side;
 
@@ -67,7 +71,28 @@ private:
 };
 
 /**
- * Order book with a bid and offer stack.
+ * Read-only view of the levels on one side of an order book.
+ */
+struct BookLevels
+{
+  const TreasuryPrice *prices;
+  const long *sizes;
+  size_t depth;
+  PricingSide side;
+
+  size_t size() const { return depth; }
+  bool empty() const { return depth == 0; }
+  Order operator[](size_t level) const { return Order(prices[level], sizes[level], side); }
+};
+
+/**
+ * Fixed-depth order book with a bid and offer stack.
+ * Prices and sizes are stored as separate cache-line-aligned arrays per side
+ * so the book is updated in place. Each side is kept in price order, best
+ * first (bids descending, offers ascending, arrival order between equal
+ * prices), so level 0 is the best level and the top N levels are the first N.
+ * Unused bid levels hold TreasuryPrice::Lowest() and unused offer levels
+ * TreasuryPrice::Highest(), with zero size.
  * Type T is the product type.
  */
 template<typename T>
@@ -76,22 +101,62 @@ class OrderBook
 
 public:
 
-  // ctor for the order book
+  // Maximum number of levels per side; one cache line of prices per side
+  static const size_t MAX_DEPTH = 8;
+
+  // ctor for an empty order book
+  explicit OrderBook(const T &_product);
+
+  // ctor for the order book from bid and offer stacks (levels beyond MAX_DEPTH are dropped)
   OrderBook(const T &_product, const vector<Order> &_bidStack, const vector<Order> &_offerStack);
 
   // Get the product
   const T& GetProduct() const;
 
-  // Get the bid stack
-  const vector<Order>& GetBidStack() const;
+  // Remove all levels from both sides
+  void Clear();
+
+  // Insert a level into the given side in price order; returns false if that side is full
+  bool AddLevel(PricingSide side, TreasuryPrice price, long quantity);
 
-  // Get the offer stack
-  const vector<Order>& GetOfferStack() const;
+  // Get the number of levels on the bid/offer side
+  size_t GetBidDepth() const;
+  size_t GetOfferDepth() const;
+
+  // Get the order at a level of the bid/offer side
+  Order GetBid(size_t level) const;
+  Order GetOffer(size_t level) const;
+
+  // Get a view of the bid/offer levels, valid while the book is alive
+  BookLevels GetBidLevels() const;
+  BookLevels GetOfferLevels() const;
+
+  // Add quantity to the level at this price, inserting a level if the price is new;
+  // returns false if the price is new and that side is full
+  bool MergeLevel(PricingSide side, TreasuryPrice price, long quantity);
+
+  // Get the level index of the highest bid/lowest offer (always 0), or MAX_DEPTH if the side is empty
+  size_t BestBidLevel() const;
+  size_t BestOfferLevel() const;
+
+  // Get the best bid and offer; throws if either side is empty
+  BidOffer GetBestBidOffer() const;
+
+  // Get the mid weighted by size over the best levels by price on each side
+  double GetDepthWeightedMid(size_t levels = MAX_DEPTH) const;
+
+  // Get the total size over the best levels by price on the bid/offer side
+  long GetCumulativeBidSize(size_t levels = MAX_DEPTH) const;
+  long GetCumulativeOfferSize(size_t levels = MAX_DEPTH) const;
 
 private:
-  T product;
-  vector<Order> bidStack;
-  vector<Order> offerStack;
+  alignas(64) TreasuryPrice bidPrices[MAX_DEPTH];
+  alignas(64) TreasuryPrice offerPrices[MAX_DEPTH];
+  alignas(64) long bidSizes[MAX_DEPTH];
+  alignas(64) long offerSizes[MAX_DEPTH];
+  const T* product;  // points into the product registry
+  uint32_t bidDepth;
+  uint32_t offerDepth;
 
 };
 
@@ -109,19 +174,19 @@ public:
   // Get the best bid/offer order
   virtual BidOffer GetBestBidOffer(const string &productId) = 0;
 
-  // Aggregate the order book
+  // Get the order book with quantity aggregated by price level
   virtual const OrderBook<T>& AggregateDepth(const string &productId) = 0;
 
 };
 
-Order::Order(double _price, long _quantity, PricingSide _side)
+Order::Order(TreasuryPrice _price, long _quantity, PricingSide _side)
 {
   price = _price;
   quantity = _quantity;
   side = _side;
 }
 
-double Order::GetPrice() const
+TreasuryPrice Order::GetPrice() const
 {
   return price;
 }
@@ -151,28 +216,173 @@ const Order& BidOffer::GetOfferOrder() const
   return offerOrder;
 }
 
+template<typename T>
+OrderBook<T>::OrderBook(const T &_product) :
+  product(&_product)
+{
+  Clear();
+}
+
 template<typename T>
 OrderBook<T>::OrderBook(const T &_product, const vector<Order> &_bidStack, const vector<Order> &_offerStack) :
-  product(_product), bidStack(_bidStack), offerStack(_offerStack)
+  OrderBook(_product)
 {
+  for (const Order &order : _bidStack) {
+    AddLevel(BID, order.GetPrice(), order.GetQuantity());
+  }
+  for (const Order &order : _offerStack) {
+    AddLevel(OFFER, order.GetPrice(), order.GetQuantity());
+  }
 }
 
 template<typename T>
 const T& OrderBook<T>::GetProduct() const
 {
-  return product;
+  return *product;
+}
+
+template<typename T>
+void OrderBook<T>::Clear()
+{
+  for (size_t i = 0; i < MAX_DEPTH; ++i) {
+    bidPrices[i] = TreasuryPrice::Lowest();
+    offerPrices[i] = TreasuryPrice::Highest();
+    bidSizes[i] = 0;
+    offerSizes[i] = 0;
+  }
+  bidDepth = 0;
+  offerDepth = 0;
+}
+
+template<typename T>
+bool OrderBook<T>::AddLevel(PricingSide side, TreasuryPrice price, long quantity)
+{
+  TreasuryPrice *prices = side == BID ? bidPrices : offerPrices;
+  long *sizes = side == BID ? bidSizes : offerSizes;
+  uint32_t &depth = side == BID ? bidDepth : offerDepth;
+  if (depth == MAX_DEPTH) return false;
+  // Shift the worse levels down one; at most MAX_DEPTH moves, and feeds
+  // that already arrive best first never shift
+  size_t level = depth;
+  while (level > 0 && (side == BID ? prices[level - 1] < price : price < prices[level - 1])) {
+    prices[level] = prices[level - 1];
+    sizes[level] = sizes[level - 1];
+    --level;
+  }
+  prices[level] = price;
+  sizes[level] = quantity;
+  ++depth;
+  return true;
+}
+
+template<typename T>
+size_t OrderBook<T>::GetBidDepth() const
+{
+  return bidDepth;
+}
+
+template<typename T>
+size_t OrderBook<T>::GetOfferDepth() const
+{
+  return offerDepth;
+}
+
+template<typename T>
+Order OrderBook<T>::GetBid(size_t level) const
+{
+  return Order(bidPrices[level], bidSizes[level], BID);
+}
+
+template<typename T>
+Order OrderBook<T>::GetOffer(size_t level) const
+{
+  return Order(offerPrices[level], offerSizes[level], OFFER);
+}
+
+template<typename T>
+BookLevels OrderBook<T>::GetBidLevels() const
+{
+  return BookLevels{bidPrices, bidSizes, bidDepth, BID};
+}
+
+template<typename T>
+BookLevels OrderBook<T>::GetOfferLevels() const
+{
+  return BookLevels{offerPrices, offerSizes, offerDepth, OFFER};
+}
+
+template<typename T>
+bool OrderBook<T>::MergeLevel(PricingSide side, TreasuryPrice price, long quantity)
+{
+  TreasuryPrice *prices = side == BID ? bidPrices : offerPrices;
+  long *sizes = side == BID ? bidSizes : offerSizes;
+  size_t depth = side == BID ? bidDepth : offerDepth;
+  for (size_t i = 0; i < depth; ++i) {
+    if (prices[i] == price) {
+      sizes[i] += quantity;
+      return true;
+    }
+  }
+  return AddLevel(side, price, quantity);
+}
+
+template<typename T>
+size_t OrderBook<T>::BestBidLevel() const
+{
+  return bidDepth == 0 ? MAX_DEPTH : 0;
+}
+
+template<typename T>
+size_t OrderBook<T>::BestOfferLevel() const
+{
+  return offerDepth == 0 ? MAX_DEPTH : 0;
+}
+
+template<typename T>
+BidOffer OrderBook<T>::GetBestBidOffer() const
+{
+  size_t bid = BestBidLevel();
+  size_t offer = BestOfferLevel();
+  if (bid == MAX_DEPTH || offer == MAX_DEPTH) {
+    throw runtime_error("Order book side is empty for product: " + product->GetProductId());
+  }
+  return BidOffer(GetBid(bid), GetOffer(offer));
+}
+
+template<typename T>
+double OrderBook<T>::GetDepthWeightedMid(size_t levels) const
+{
+  double notional = 0.0;
+  long size = 0;
+  for (size_t i = 0; i < min<size_t>(levels, bidDepth); ++i) {
+    notional += bidPrices[i].ToDecimal() * bidSizes[i];
+    size += bidSizes[i];
+  }
+  for (size_t i = 0; i < min<size_t>(levels, offerDepth); ++i) {
+    notional += offerPrices[i].ToDecimal() * offerSizes[i];
+    size += offerSizes[i];
+  }
+  return size == 0 ? 0.0 : notional / size;
 }
 
 template<typename T>
-const vector<Order>& OrderBook<T>::GetBidStack() const
+long OrderBook<T>::GetCumulativeBidSize(size_t levels) const
 {
-  return bidStack;
+  long size = 0;
+  for (size_t i = 0; i < min<size_t>(levels, bidDepth); ++i) {
+    size += bidSizes[i];
+  }
+  return size;
 }
 
 template<typename T>
-const vector<Order>& OrderBook<T>::GetOfferStack() const
+long OrderBook<T>::GetCumulativeOfferSize(size_t levels) const
 {
-  return offerStack;
+  long size = 0;
+  for (size_t i = 0; i < min<size_t>(levels, offerDepth); ++i) {
+    size += offerSizes[i];
+  }
+  return size;
 }
 
 #endif
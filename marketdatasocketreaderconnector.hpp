@@ -18,19 +18,43 @@
 #include "pricesocketreaderconnector.hpp"
 #include "tradebookingservice.hpp"
 #include "marketdataservice.hpp"
+#include "fieldparser.hpp"
+#include "lineframer.hpp"
+
+// Parse a raw line into an OrderBook<Bond> object and publish it through the connector
+inline ParseError PublishOrderBookLine(std::string_view line, Connector<OrderBook<Bond>>& connector) {
+    OrderBookRecord record;
+    ParseError error = ParseOrderBookRecord(line, record);
+    if (error != PARSE_OK) {
+        return error;
+    }
 
-extern std::map<std::string, Bond> bondMap;
+    const Bond* bond = SecurityMaster::Get().FindBond(record.cusip);
+    if (bond == nullptr) {
+        return PARSE_UNKNOWN_CUSIP;
+    }
+
+    OrderBook<Bond> orderbook(*bond);
+    for (size_t i = 0; i < record.levelCount; ++i) {
+        const BookLevelRecord& level = record.levels[i];
+        if (!orderbook.AddLevel(level.side, level.price, level.quantity)) {
+            return PARSE_TOO_MANY_LEVELS;
+        }
+    }
+    connector.Publish(orderbook);
+    return PARSE_OK;
+}
 
 class MarketDataSocketReaderConnector : public Connector<OrderBook<Bond>> {
 private:
     int socketFd;
     Service<std::string, OrderBook<Bond>>* targetService;
-    std::map<std::string,long> quantityMap;
     bool running;
+    size_t receiveBufferSize;
 
 public:
-    MarketDataSocketReaderConnector(int port, Service<std::string, OrderBook<Bond>>* service) 
-        : targetService(service), running(true) {
+    MarketDataSocketReaderConnector(int port, Service<std::string, OrderBook<Bond>>* service, size_t _receiveBufferSize = LineFramer::DEFAULT_CAPACITY) 
+        : targetService(service), running(true), receiveBufferSize(_receiveBufferSize) {
         // Create socket
         socketFd = socket(AF_INET, SOCK_STREAM, 0);
         if (socketFd < 0) {
@@ -61,7 +85,6 @@ public:
             perror("Listen failed");
             exit(1);
         }
-        quantityMap = std::map<std::string,long>({{"10M",10000000},{"20M",20000000},{"30M",30000000},{"40M",40000000},{"50M",50000000}});
     }
 
     void Stop() {
@@ -85,33 +108,25 @@ public:
                 }
                 std::cerr << "Client connected!" << std::endl;
 
-                std::string accumulated;
-                char buffer[1024];
+                LineFramer framer(receiveBufferSize);
                 while (running) {
-                    int bytesRead = read(clientFd, buffer, sizeof(buffer) - 1);
+                    ssize_t bytesRead = framer.ReadFrom(clientFd);
                     if (bytesRead <= 0) {
                         std::cerr << "Connection closed or error (bytesRead: " << bytesRead << ")" << std::endl;
                         break;
                     }
-                    
-                    buffer[bytesRead] = '\0';
-                    accumulated += buffer;
-                    
-                    size_t pos;
-                    while ((pos = accumulated.find('\n')) != std::string::npos) {
-                        std::string line = accumulated.substr(0, pos);
-                        if (!line.empty() && line[line.length()-1] == '\r') {
-                            line = line.substr(0, line.length()-1);  // Remove \r if present
-                        }
+
+                    framer.ForEachLine([this](std::string_view line) {
                         try {
-                            OrderBook<Bond> orderbook_obj = MakeOrderBook(line);
-                            Publish(orderbook_obj);
+                            ParseError error = PublishLine(line);
+                            if (error != PARSE_OK) {
+                                std::cerr << "Error processing line: " << ParseErrorString(error) << ": " << line << std::endl;
+                            }
                         }
                         catch (const std::exception& e) {
                             std::cerr << "Error processing line: " << e.what() << std::endl;
                         }
-                        accumulated = accumulated.substr(pos + 1);
-                    }
+                    });
                 }
                 std::cerr << "Client connection closed" << std::endl;
                 close(clientFd);
@@ -126,80 +141,9 @@ public:
         targetService->OnMessage(data);
     }
 
-    // Parse raw string into Price<Bond> object
-    OrderBook<Bond> MakeOrderBook(std::string input) {
-        // First check if the string is long enough
-        if (input.length() < 41) {  
-            throw std::runtime_error("Input string too short: " + input);
-        }
-        // Parse timestamp before first comma
-        size_t comma_pos = input.find(',');
-        if (comma_pos == string::npos) {
-            throw std::runtime_error("No comma found in input: " + input);
-        }
-        std::string cusip = input.substr(0, comma_pos);
-        
-        // Move past the comma and space
-        input = input.substr(comma_pos + 2);
-
-        // Parse remaining items in groups of 3
-        std::vector<std::string> items;
-        int count = 0;
-        PricingSide side = (PricingSide)0;
-        double price = 0;
-        long quantity = 0;
-        vector<Order> bids;
-        vector<Order> offers;
-        try {
-            while (!input.empty()) {
-                comma_pos = input.find(',');
-                if (comma_pos == string::npos) {
-                    quantity = quantityMap.find(input)->second;
-                    if (side == BID){
-                        bids.push_back(Order(price, quantity, side));
-                    }
-                    else {
-                        offers.push_back(Order(price, quantity, side));
-                    }
-                    break;
-                }
-                if (count == 0) {
-                    side = (PricingSide)std::stoi(input.substr(0, comma_pos));
-                }
-                else if (count == 1) {
-                    price = std::stod(input.substr(0, 3));
-                    price = price + std::stod(input.substr(4, 2))/32;
-                    if (input.substr(6, 1) == "+") {
-                        price = price + 1.0/64.0;
-                    }
-                    else {
-                        price = price + std::stod(input.substr(6, 1))/256;
-                    }
-                }
-                else if (count == 2) {
-                    quantity = quantityMap.find(input.substr(0, comma_pos))->second;
-                    if (side == BID){
-                        bids.push_back(Order(price, quantity, side));
-                    }
-                    else {
-                        offers.push_back(Order(price, quantity, side));
-                    }
-                    count = -1;
-                }
-                input = input.substr(comma_pos + 2); // Skip comma and space
-                count++;
-            }
-            if (bondMap.find(cusip) == bondMap.end()) {
-                throw std::runtime_error("Unknown CUSIP: " + cusip);
-            }
-            return OrderBook<Bond>(bondMap.find(cusip)->second, bids, offers);
-        }
-        catch (const std::out_of_range& e) {
-            throw std::runtime_error("Invalid string format: " + input);
-        }
-        catch (const std::invalid_argument& e) {
-            throw std::runtime_error("Invalid number format in: " + input);
-        }
+    // Parse a raw line into an OrderBook<Bond> object and publish it to the service
+    ParseError PublishLine(std::string_view line) {
+        return PublishOrderBookLine(line, *this);
     }
 
     ~MarketDataSocketReaderConnector() {
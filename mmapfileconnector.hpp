@@ -0,0 +1,115 @@
+/**
+ * mmapfileconnector.hpp
+ * Subscriber connector that memory maps an input file and publishes each line
+ * directly to a Service, skipping the loopback socket used for live feeds.
+ */
+#ifndef MMAP_FILE_CONNECTOR_HPP
+#define MMAP_FILE_CONNECTOR_HPP
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "soa.hpp"
+#include "fieldparser.hpp"
+
+template<typename V>
+class MmapFileConnector : public Connector<V> {
+public:
+    // Parses one line and publishes the resulting object through the connector
+    typedef ParseError (*LineDecoder)(std::string_view line, Connector<V>& connector);
+
+private:
+    std::string filename;
+    Service<std::string, V>* targetService;
+    LineDecoder decoder;
+    int fileFd;
+    const char* mapped;
+    size_t length;
+
+    void Unmap() {
+        if (mapped != nullptr) {
+            munmap(const_cast<char*>(mapped), length);
+            mapped = nullptr;
+        }
+        if (fileFd >= 0) {
+            close(fileFd);
+            fileFd = -1;
+        }
+    }
+
+public:
+    MmapFileConnector(const std::string& _filename, Service<std::string, V>* service, LineDecoder _decoder)
+        : filename(_filename), targetService(service), decoder(_decoder), fileFd(-1), mapped(nullptr), length(0) {
+        fileFd = open(filename.c_str(), O_RDONLY);
+        if (fileFd < 0) {
+            perror(("Failed to open file " + filename).c_str());
+            return;
+        }
+        struct stat fileStat;
+        if (fstat(fileFd, &fileStat) < 0) {
+            perror("fstat failed");
+            Unmap();
+            return;
+        }
+        length = fileStat.st_size;
+        if (length == 0) {
+            return;
+        }
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileFd, 0);
+        if (address == MAP_FAILED) {
+            perror("mmap failed");
+            length = 0;
+            Unmap();
+            return;
+        }
+        mapped = static_cast<const char*>(address);
+        madvise(address, length, MADV_SEQUENTIAL);
+    }
+
+    // Override the Publish method to hand the data to the service
+    void Publish(V& data) override {
+        targetService->OnMessage(data);
+    }
+
+    // Decode and publish every line of the file in order; returns the number of lines published
+    size_t ReadFromFileAndPublish() {
+        size_t published = 0;
+        size_t pos = 0;
+        while (pos < length) {
+            const char* newline = static_cast<const char*>(memchr(mapped + pos, '\n', length - pos));
+            size_t end = newline != nullptr ? newline - mapped : length;
+            size_t lineLength = end - pos;
+            if (lineLength > 0 && mapped[end - 1] == '\r') {
+                lineLength--;  // Remove \r if present
+            }
+            std::string_view line(mapped + pos, lineLength);
+            pos = end + 1;
+            if (line.empty()) {
+                continue;
+            }
+            try {
+                ParseError error = decoder(line, *this);
+                if (error != PARSE_OK) {
+                    std::cerr << "Error processing line: " << ParseErrorString(error) << ": " << line << std::endl;
+                    continue;
+                }
+                published++;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error processing line: " << e.what() << std::endl;
+            }
+        }
+        return published;
+    }
+
+    ~MmapFileConnector() {
+        Unmap();
+    }
+};
+
+#endif
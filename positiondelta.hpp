@@ -0,0 +1,26 @@
+/**
+ * positiondelta.hpp
+ * Compact per-trade position change passed from trade booking through the
+ * position and risk services in place of full trade and position objects.
+ */
+#ifndef POSITION_DELTA_HPP
+#define POSITION_DELTA_HPP
+
+#include <cstdint>
+#include "bookregistry.hpp"
+
+/**
+ * Change to one book's position in one product, booked by a single trade.
+ * Trade booking fills in the product, book and signed change; the position
+ * service fills in the product's aggregate after applying it, so downstream
+ * consumers that only track the total never need the full Position.
+ */
+struct PositionDelta
+{
+  uint32_t productIndex;    // index in the security master
+  BookId book;
+  long quantityChange;      // buys positive, sells negative
+  long aggregatePosition;   // set by the position service
+};
+
+#endif
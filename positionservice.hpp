@@ -8,14 +8,19 @@
 #define POSITION_SERVICE_HPP
 
 #include <string>
-#include <map>
+#include <array>
+#include <algorithm>
+#include <charconv>
 #include "soa.hpp"
 #include "tradebookingservice.hpp"
+#include "bookregistry.hpp"
 #include "products.hpp"
 using namespace std;
 
 /**
  * Position class in a particular book.
+ * Quantities are held in one slot per interned book ID, and the aggregate is
+ * maintained as positions change, so booking a trade is two adds.
  * Type T is the product type.
  */
 template<typename T>
@@ -31,9 +36,15 @@ public:
   const T& GetProduct() const;
 
   // Get the position quantity
-  long GetPosition(string &book);
+  long GetPosition(const string &book) const;
 
-  long AddPosition(string &book, long quantity);
+  // Get the position quantity for an interned book
+  long GetPosition(BookId book) const;
+
+  long AddPosition(const string &book, long quantity);
+
+  // Add to the position of an interned book and return the new quantity
+  long AddPosition(BookId book, long quantity);
 
   // Get the aggregate position
   long GetAggregatePosition() const;
@@ -42,8 +53,10 @@ public:
   string to_string() const;
 
 private:
-  T product;
-  map<string,long> positions;
+  const T* product;  // points into the product registry
+  array<long, BookRegistry::MAX_BOOKS> positions;  // by book ID
+  uint32_t bookMask;  // bit per book ID that has been traded
+  long aggregatePosition;
 
 };
 
@@ -62,54 +75,74 @@ public:
 
 template<typename T>
 Position<T>::Position(const T &_product) :
-  product(_product)
+  product(&_product), bookMask(0), aggregatePosition(0)
 {
+  positions.fill(0);
 }
 
 template<typename T>
 const T& Position<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
-long Position<T>::GetPosition(string &book)
+long Position<T>::GetPosition(const string &book) const
 {
-  if (positions.find(book) == positions.end()) {
-    return 0;
-  }
-  return positions[book];
+  BookId id = BookRegistry::Find(book);
+  return id == BookRegistry::NO_BOOK ? 0 : positions[id];
 }
 
 template<typename T>
-long Position<T>::AddPosition(string &book, long quantity)
+long Position<T>::GetPosition(BookId book) const
 {
-  if (positions.find(book) == positions.end()) {
-    positions[book] = 0;
-  }
-  positions[book] += quantity;
   return positions[book];
 }
 
+template<typename T>
+long Position<T>::AddPosition(const string &book, long quantity)
+{
+  return AddPosition(BookRegistry::Intern(book), quantity);
+}
+
+template<typename T>
+long Position<T>::AddPosition(BookId book, long quantity)
+{
+  bookMask |= 1u << book;
+  aggregatePosition += quantity;
+  return positions[book] += quantity;
+}
+
 template<typename T>
 long Position<T>::GetAggregatePosition() const
 {
-  long aggregatePosition = 0;
-  for (auto it = positions.begin(); it != positions.end(); ++it) {
-    aggregatePosition += it->second;
-  }
   return aggregatePosition;
 }
 
 template<typename T>
 string Position<T>::to_string() const {
-  stringstream ss;
-  ss << product.GetProductId() << "," ;
-  for (const auto& entry : positions) {
-    ss << entry.first << "," << entry.second << ",";
+  // Books in name order, as the CSV has always listed them
+  BookId books[BookRegistry::MAX_BOOKS];
+  uint32_t bookCount = 0;
+  for (uint32_t mask = bookMask; mask != 0; mask &= mask - 1) {
+    books[bookCount++] = __builtin_ctz(mask);
+  }
+  sort(books, books + bookCount, [](BookId a, BookId b) { return BookRegistry::Name(a) < BookRegistry::Name(b); });
+
+  const string &productId = product->GetProductId();
+  string out;
+  out.reserve(productId.size() + bookCount * 32 + 32);
+  char number[24];
+  out.append(productId).push_back(',');
+  for (uint32_t i = 0; i < bookCount; ++i) {
+    out.append(BookRegistry::Name(books[i])).push_back(',');
+    char *end = std::to_chars(number, number + sizeof(number), positions[books[i]]).ptr;
+    out.append(number, end).push_back(',');
   }
-  ss << "Aggregate," <<GetAggregatePosition();
-  return ss.str();
+  out.append("Aggregate,");
+  char *end = std::to_chars(number, number + sizeof(number), aggregatePosition).ptr;
+  out.append(number, end);
+  return out;
 }
 
 #endif
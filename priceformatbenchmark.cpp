@@ -0,0 +1,105 @@
+/**
+ * priceformatbenchmark.cpp
+ * Times the price formatters in helperfunction.hpp against the stringstream
+ * versions they replaced, after checking both produce the same text for every
+ * price tick in the benchmark range. Exits non-zero if the output differs or
+ * either char buffer formatter is less than REQUIRED_SPEEDUP times faster.
+ * Usage: price_format_benchmark [iterations]
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "helperfunction.hpp"
+
+// The stringstream formatters helperfunction.hpp used to provide
+std::string legacy_convert_to_fractional(double price){
+    std::stringstream converted_ss;
+    converted_ss << floor(price+0.0000001) << '-';
+    converted_ss << std::setw(2) << std::setfill('0') << (int)(((int) std::round(price * 256.0) % 256)/8);
+    int last_digit = (int)((int) std::round(price * 256.0)) % 8;
+    converted_ss << std::setw(1) << (last_digit == 4 ? "+" : std::to_string(last_digit));
+    return converted_ss.str();
+}
+
+std::string legacy_convert_to_256th(double price){
+    std::stringstream converted_ss;
+    converted_ss << std::round(price * 256.0) << "/256";
+    return converted_ss.str();
+}
+
+static const double REQUIRED_SPEEDUP = 10.0;
+
+// Run format over every price iterations times and return nanoseconds per call.
+// The output lengths are summed into sink so the calls cannot be optimized away
+template<typename Format>
+double TimePerCall(const std::vector<TreasuryPrice> &prices, int iterations, size_t &sink, Format format) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (TreasuryPrice price : prices) {
+            sink += format(price);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(iterations) * prices.size());
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+    if (iterations <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [iterations]" << std::endl;
+        return 1;
+    }
+
+    // Every tick from 98-00 to 102-00, plus small spreads
+    std::vector<TreasuryPrice> prices;
+    for (int64_t ticks = TreasuryPrice::FromPoints(98).Ticks(); ticks < TreasuryPrice::FromPoints(102).Ticks(); ++ticks) {
+        prices.push_back(TreasuryPrice::FromTicks(ticks));
+    }
+    for (int64_t ticks = 1; ticks <= 8; ++ticks) {
+        prices.push_back(TreasuryPrice::FromTicks(ticks));
+    }
+
+    char buffer[PRICE_FORMAT_LENGTH];
+    for (TreasuryPrice price : prices) {
+        if (legacy_convert_to_256th(price.ToDecimal()) != std::string(buffer, convert_to_256th(price, buffer))) {
+            std::cerr << "Error: 256ths mismatch at " << price.Ticks() << " ticks" << std::endl;
+            return 1;
+        }
+        if (price.Ticks() >= TreasuryPrice::TICKS_PER_POINT &&
+            legacy_convert_to_fractional(price.ToDecimal()) != std::string(buffer, convert_to_fractional(price, buffer))) {
+            std::cerr << "Error: Fractional mismatch at " << price.Ticks() << " ticks" << std::endl;
+            return 1;
+        }
+    }
+
+    size_t sink = 0;
+    double legacyFractional = TimePerCall(prices, iterations, sink,
+        [](TreasuryPrice price) { return legacy_convert_to_fractional(price.ToDecimal()).size(); });
+    double stringFractional = TimePerCall(prices, iterations, sink,
+        [](TreasuryPrice price) { return convert_to_fractional(price).size(); });
+    double bufferFractional = TimePerCall(prices, iterations, sink,
+        [&buffer](TreasuryPrice price) { return convert_to_fractional(price, buffer); });
+    double legacy256th = TimePerCall(prices, iterations, sink,
+        [](TreasuryPrice price) { return legacy_convert_to_256th(price.ToDecimal()).size(); });
+    double string256th = TimePerCall(prices, iterations, sink,
+        [](TreasuryPrice price) { return convert_to_256th(price).size(); });
+    double buffer256th = TimePerCall(prices, iterations, sink,
+        [&buffer](TreasuryPrice price) { return convert_to_256th(price, buffer); });
+
+    std::cout << std::fixed << std::setprecision(1)
+              << prices.size() << " prices x " << iterations << " iterations (checksum " << sink << ")\n"
+              << "convert_to_fractional: stringstream " << legacyFractional << " ns, string " << stringFractional
+              << " ns, char buffer " << bufferFractional << " ns (" << legacyFractional / bufferFractional << "x)\n"
+              << "convert_to_256th:      stringstream " << legacy256th << " ns, string " << string256th
+              << " ns, char buffer " << buffer256th << " ns (" << legacy256th / buffer256th << "x)" << std::endl;
+    if (legacyFractional / bufferFractional < REQUIRED_SPEEDUP || legacy256th / buffer256th < REQUIRED_SPEEDUP) {
+        std::cerr << "Error: Char buffer formatters are less than " << REQUIRED_SPEEDUP << "x faster" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * productlocks.hpp
+ * One mutex per registered product, so services touched by several threads
+ * only serialise updates to the same CUSIP.
+ */
+#ifndef PRODUCT_LOCKS_HPP
+#define PRODUCT_LOCKS_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Fixed set of mutexes indexed by product index.
+ * Each mutex sits on its own cache line so threads working on different
+ * products do not share lines. Services that call into each other while
+ * holding a product lock always nest in pipeline order
+ * (trade booking -> position -> risk), which keeps the locking deadlock free.
+ */
+class ProductLocks
+{
+
+public:
+
+  // ctor for one lock per product
+  explicit ProductLocks(size_t productCount) :
+    locks(productCount)
+  {
+  }
+
+  // Get the lock guarding the given product index
+  std::mutex& operator[](uint32_t productIndex) {
+    return locks[productIndex].mutex;
+  }
+
+private:
+  struct alignas(64) PaddedMutex {
+    std::mutex mutex;
+  };
+
+  std::vector<PaddedMutex> locks;
+
+};
+
+#endif
@@ -0,0 +1,333 @@
+/**
+ * productregistry.hpp
+ * Interns every CUSIP in the security master to a dense product index.
+ * Services key their per-product state arrays by that index.
+ */
+#ifndef PRODUCT_REGISTRY_HPP
+#define PRODUCT_REGISTRY_HPP
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+#include <stdexcept>
+#include "products.hpp"
+
+// Parse a whole number field with from_chars; false unless the field is fully consumed
+inline bool ParseCsvNumber(std::string_view field, int &value) {
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+// Load the bonds in a TBonds.csv style file: CUSIP,CUSIP,ticker,coupon,MM/DD/YYYY
+inline std::vector<Bond> LoadBondsFromCsv(const std::string &filename) {
+    std::vector<Bond> bonds;
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open " << filename << std::endl;
+        return bonds;
+    }
+    std::string contents(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&contents[0], contents.size());
+
+    std::string_view remaining(contents);
+    while (!remaining.empty()) {
+        size_t newline = remaining.find('\n');
+        std::string_view line = remaining.substr(0, newline);
+        remaining = newline == std::string_view::npos ? std::string_view() : remaining.substr(newline + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        std::string_view fields[5];
+        size_t count = 0;
+        std::string_view rest = line;
+        while (count < 5) {
+            size_t comma = rest.find(',');
+            fields[count++] = rest.substr(0, comma);
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            rest.remove_prefix(comma + 1);
+        }
+        if (count < 5) {
+            std::cerr << "Warning: Skipping malformed line in CSV" << std::endl;
+            continue;
+        }
+
+        float coupon = 0.0f;
+        auto couponResult = std::from_chars(fields[3].data(), fields[3].data() + fields[3].size(), coupon);
+        std::string_view maturity = fields[4];
+        size_t firstSlash = maturity.find('/');
+        size_t secondSlash = firstSlash == std::string_view::npos ? firstSlash : maturity.find('/', firstSlash + 1);
+        int month = 0, day = 0, year = 0;
+        if (couponResult.ec != std::errc() || secondSlash == std::string_view::npos ||
+            !ParseCsvNumber(maturity.substr(0, firstSlash), month) ||
+            !ParseCsvNumber(maturity.substr(firstSlash + 1, secondSlash - firstSlash - 1), day) ||
+            !ParseCsvNumber(maturity.substr(secondSlash + 1), year)) {
+            std::cerr << "Warning: Invalid coupon or date format for product " << fields[0] << std::endl;
+            continue;
+        }
+        if (year < 100) {
+            year += 2000;
+        }
+        try {
+            bonds.emplace_back(std::string(fields[0]), CUSIP, std::string(fields[2]), coupon, date(year, month, day));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error processing line: " << e.what() << std::endl;
+        }
+    }
+    return bonds;
+}
+
+/**
+ * Registry of bonds indexed 0..Size()-1 in CUSIP order.
+ * CUSIP lookups go through a hash-and-displace perfect hash built at load time,
+ * so a lookup is two hashes of the 9 byte key and one key compare.
+ */
+class ProductRegistry
+{
+
+public:
+
+  static constexpr uint32_t NOT_FOUND = 0xFFFFFFFF;
+  static constexpr size_t CUSIP_LENGTH = 9;
+
+  // ctor from the bonds loaded out of the security master
+  explicit ProductRegistry(std::vector<Bond> bonds);
+
+  // ctor from bonds already in CUSIP order and a lookup table saved by a previous registry;
+  // the table is rebuilt if it does not find every bond
+  ProductRegistry(std::vector<Bond> bonds, std::vector<uint32_t> displacements, std::vector<uint32_t> slots);
+
+  // Number of products in the registry
+  size_t Size() const;
+
+  // Get the product index for a CUSIP, or NOT_FOUND
+  uint32_t Find(std::string_view cusip) const;
+
+  // Get the product index of a bond; throws if the bond is not registered
+  uint32_t IndexOf(const Bond &bond) const;
+
+  // Get the bond for a product index
+  const Bond& GetBond(uint32_t index) const;
+
+  // Get the bond for a CUSIP, or nullptr
+  const Bond* FindBond(std::string_view cusip) const;
+
+  // Get all bonds in index order
+  const std::vector<Bond>& GetBonds() const;
+
+  // Get the lookup table, for saving it alongside the bonds
+  const std::vector<uint32_t>& GetDisplacements() const;
+  const std::vector<uint32_t>& GetSlots() const;
+
+private:
+  std::vector<Bond> bonds;
+  std::vector<char> keys;                 // CUSIP_LENGTH bytes per product
+  std::vector<uint32_t> displacements;    // per first-level bucket
+  std::vector<uint32_t> slots;            // product index per table slot
+  uint64_t slotMask;
+
+  static uint64_t Hash(const char *key, uint64_t seed);
+  void Build();
+  bool BuildTable(size_t tableSize);
+
+};
+
+inline uint64_t ProductRegistry::Hash(const char *key, uint64_t seed)
+{
+  uint64_t head;
+  memcpy(&head, key, sizeof(head));
+  uint64_t h = head ^ (static_cast<uint64_t>(static_cast<unsigned char>(key[8])) << 32) ^ (seed * 0x9E3779B97F4A7C15ULL);
+  // splitmix64 finalizer
+  h ^= h >> 30;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 27;
+  h *= 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+  return h;
+}
+
+inline ProductRegistry::ProductRegistry(std::vector<Bond> loaded) :
+  slotMask(0)
+{
+  // Index products in CUSIP order
+  std::sort(loaded.begin(), loaded.end(), [](const Bond &a, const Bond &b) {
+    return a.GetProductId() < b.GetProductId();
+  });
+  bonds.reserve(loaded.size());
+  for (Bond &bond : loaded) {
+    const std::string &cusip = bond.GetProductId();
+    if (cusip.size() != CUSIP_LENGTH) {
+      std::cerr << "Warning: Skipping product with non CUSIP id " << cusip << std::endl;
+      continue;
+    }
+    if (!bonds.empty() && bonds.back().GetProductId() == cusip) {
+      std::cerr << "Failed to insert bond with ID: " << cusip << " (duplicate key?)" << std::endl;
+      continue;
+    }
+    keys.insert(keys.end(), cusip.begin(), cusip.end());
+    bonds.push_back(std::move(bond));
+  }
+  Build();
+}
+
+inline ProductRegistry::ProductRegistry(std::vector<Bond> loaded, std::vector<uint32_t> _displacements, std::vector<uint32_t> _slots) :
+  bonds(std::move(loaded)), displacements(std::move(_displacements)), slots(std::move(_slots)), slotMask(0)
+{
+  keys.reserve(bonds.size() * CUSIP_LENGTH);
+  for (const Bond &bond : bonds) {
+    const std::string &cusip = bond.GetProductId();
+    keys.insert(keys.end(), cusip.begin(), cusip.end());
+  }
+  bool valid = !displacements.empty() && !slots.empty() && (slots.size() & (slots.size() - 1)) == 0 &&
+    keys.size() == bonds.size() * CUSIP_LENGTH;
+  if (valid) {
+    slotMask = slots.size() - 1;
+    for (size_t i = 0; i < slots.size() && valid; ++i) {
+      valid = slots[i] == NOT_FOUND || slots[i] < bonds.size();
+    }
+    for (uint32_t i = 0; i < bonds.size() && valid; ++i) {
+      valid = Find(bonds[i].GetProductId()) == i;
+    }
+  }
+  if (!valid) {
+    std::cerr << "Warning: Saved CUSIP index does not match the products; rebuilding it" << std::endl;
+    Build();
+  }
+}
+
+inline void ProductRegistry::Build()
+{
+  size_t tableSize = 1;
+  while (tableSize < bonds.size() * 2) {
+    tableSize <<= 1;
+  }
+  while (!BuildTable(tableSize)) {
+    tableSize <<= 1;
+  }
+}
+
+inline bool ProductRegistry::BuildTable(size_t tableSize)
+{
+  const size_t count = bonds.size();
+  const size_t bucketCount = count / 2 + 1;
+  slots.assign(tableSize, NOT_FOUND);
+  displacements.assign(bucketCount, 0);
+  slotMask = tableSize - 1;
+
+  std::vector<std::vector<uint32_t>> buckets(bucketCount);
+  for (uint32_t i = 0; i < count; ++i) {
+    buckets[Hash(&keys[i * CUSIP_LENGTH], 0) % bucketCount].push_back(i);
+  }
+  std::vector<uint32_t> order(bucketCount);
+  for (uint32_t b = 0; b < bucketCount; ++b) {
+    order[b] = b;
+  }
+  std::sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  // Place the largest buckets first, searching for a displacement that lands all their keys on free slots
+  std::vector<uint64_t> candidate;
+  for (uint32_t b : order) {
+    const std::vector<uint32_t>& bucket = buckets[b];
+    if (bucket.empty()) {
+      break;
+    }
+    bool placed = false;
+    for (uint32_t d = 1; d < (1u << 20) && !placed; ++d) {
+      candidate.clear();
+      placed = true;
+      for (uint32_t i : bucket) {
+        uint64_t slot = Hash(&keys[i * CUSIP_LENGTH], d) & slotMask;
+        if (slots[slot] != NOT_FOUND || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+          placed = false;
+          break;
+        }
+        candidate.push_back(slot);
+      }
+      if (placed) {
+        displacements[b] = d;
+        for (size_t k = 0; k < bucket.size(); ++k) {
+          slots[candidate[k]] = bucket[k];
+        }
+      }
+    }
+    if (!placed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline size_t ProductRegistry::Size() const
+{
+  return bonds.size();
+}
+
+inline uint32_t ProductRegistry::Find(std::string_view cusip) const
+{
+  if (cusip.size() != CUSIP_LENGTH || bonds.empty()) {
+    return NOT_FOUND;
+  }
+  uint32_t d = displacements[Hash(cusip.data(), 0) % displacements.size()];
+  uint32_t index = slots[Hash(cusip.data(), d) & slotMask];
+  if (index == NOT_FOUND || memcmp(&keys[index * CUSIP_LENGTH], cusip.data(), CUSIP_LENGTH) != 0) {
+    return NOT_FOUND;
+  }
+  return index;
+}
+
+inline uint32_t ProductRegistry::IndexOf(const Bond &bond) const
+{
+  // Events carry pointers into the registry, so this is usually pointer arithmetic
+  if (!bonds.empty() && &bond >= bonds.data() && &bond < bonds.data() + bonds.size()) {
+    return static_cast<uint32_t>(&bond - bonds.data());
+  }
+  uint32_t index = Find(bond.GetProductId());
+  if (index == NOT_FOUND) {
+    throw std::invalid_argument("Product not registered: " + bond.GetProductId());
+  }
+  return index;
+}
+
+inline const Bond& ProductRegistry::GetBond(uint32_t index) const
+{
+  return bonds[index];
+}
+
+inline const Bond* ProductRegistry::FindBond(std::string_view cusip) const
+{
+  uint32_t index = Find(cusip);
+  return index == NOT_FOUND ? nullptr : &bonds[index];
+}
+
+inline const std::vector<Bond>& ProductRegistry::GetBonds() const
+{
+  return bonds;
+}
+
+inline const std::vector<uint32_t>& ProductRegistry::GetDisplacements() const
+{
+  return displacements;
+}
+
+inline const std::vector<uint32_t>& ProductRegistry::GetSlots() const
+{
+  return slots;
+}
+
+#endif
\ No newline at end of file
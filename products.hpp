@@ -70,7 +70,6 @@ public:
   friend ostream& operator<<(ostream &output, const Bond &bond);
 
 private:
-  string productId;
   BondIdType bondIdType;
   string ticker;
   float coupon;
@@ -183,7 +182,7 @@ Bond::Bond(string _productId, BondIdType _bondIdType, string _ticker, float _cou
   maturityDate =_maturityDate;
 }
 
-Bond::Bond() : Product(0, BOND)
+Bond::Bond() : Product("", BOND)
 {
 }
 
@@ -231,7 +230,7 @@ IRSwap::IRSwap(string _productId, DayCountConvention _fixedLegDayCountConvention
   terminationDate =_terminationDate;
 }
 
-IRSwap::IRSwap() : Product(0, IRSWAP)
+IRSwap::IRSwap() : Product("", IRSWAP)
 {
 }
 
@@ -10,6 +10,32 @@
 #include "soa.hpp"
 #include "positionservice.hpp"
 
+/**
+ * How a PV01 holds its product: by value in general, so the PV01 never
+ * outlives what it describes, and by pointer for bonds, which live in the
+ * product registry for the whole run.
+ * Type T is the product type.
+ */
+template<typename T>
+struct PV01Product
+{
+  T product;
+
+  PV01Product() : product() {}
+  explicit PV01Product(const T &_product) : product(_product) {}
+  const T& Get() const { return product; }
+};
+
+template<>
+struct PV01Product<Bond>
+{
+  const Bond* product;  // points into the product registry
+
+  PV01Product() : product(nullptr) {}
+  explicit PV01Product(const Bond &_product) : product(&_product) {}
+  const Bond& Get() const { return *product; }
+};
+
 /**
  * PV01 risk.
  * Type T is the product type.
@@ -41,7 +67,7 @@ public:
   }
 
 private:
-  T product;
+  PV01Product<T> product;
   double pv01;
   long quantity;
 
@@ -113,7 +139,7 @@ PV01<T>::PV01(const T &_product, double _pv01, long _quantity) :
 
 template<typename T>
 const T& PV01<T>::GetProduct() const {
-  return product;
+  return product.Get();
 }
 
 template<typename T>
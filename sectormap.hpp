@@ -0,0 +1,96 @@
+/**
+ * sectormap.hpp
+ * Maps each product to a risk bucket sector, loaded from a CUSIP,Sector file.
+ */
+#ifndef SECTOR_MAP_HPP
+#define SECTOR_MAP_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "products.hpp"
+#include "riskservice.hpp"
+#include "productregistry.hpp"
+#include "fieldparser.hpp"
+
+/**
+ * Sector assignment for every product in the registry.
+ * Sectors are numbered 0..SectorCount()-1 in order of first appearance in the
+ * mapping file. Products missing from the file have no sector.
+ */
+class SectorMap
+{
+
+public:
+
+  static constexpr uint32_t NO_SECTOR = 0xFFFFFFFF;
+
+  // ctor that loads the mapping file for the products in the registry
+  SectorMap(const ProductRegistry &registry, const string &filename = "TSectors.csv") :
+    sectorOf(registry.Size(), NO_SECTOR)
+  {
+    ifstream file(filename);
+    if (!file.is_open()) {
+      cerr << "Error: Unable to open " << filename << endl;
+      return;
+    }
+    vector<vector<Bond>> members;
+    string line;
+    while (getline(file, line)) {
+      FieldCursor cursor(line);
+      string_view cusip;
+      string_view name;
+      if (!cursor.Next(cusip) || !cursor.Next(name) || cusip.empty() || name.empty()) {
+        if (!TrimField(line).empty()) {
+          cerr << "Warning: Skipping malformed line in " << filename << ": " << line << endl;
+        }
+        continue;
+      }
+      uint32_t productIndex = registry.Find(cusip);
+      if (productIndex == ProductRegistry::NOT_FOUND) {
+        cerr << "Warning: Unknown CUSIP in " << filename << ": " << cusip << endl;
+        continue;
+      }
+      uint32_t sector = 0;
+      while (sector < names.size() && names[sector] != name) {
+        sector++;
+      }
+      if (sector == names.size()) {
+        names.emplace_back(name);
+        members.emplace_back();
+      }
+      sectorOf[productIndex] = sector;
+      members[sector].push_back(registry.GetBond(productIndex));
+    }
+    sectors.reserve(names.size());
+    for (uint32_t sector = 0; sector < names.size(); ++sector) {
+      sectors.emplace_back(members[sector], names[sector]);
+    }
+  }
+
+  // Number of sectors
+  size_t SectorCount() const {
+    return sectors.size();
+  }
+
+  // Get the sector of a product index, or NO_SECTOR
+  uint32_t SectorOf(uint32_t productIndex) const {
+    return sectorOf[productIndex];
+  }
+
+  // Get a sector by index
+  const BucketedSector<Bond>& GetSector(uint32_t sector) const {
+    return sectors[sector];
+  }
+
+private:
+  vector<uint32_t> sectorOf;  // by product index
+  vector<string> names;
+  vector<BucketedSector<Bond>> sectors;
+
+};
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * securitymaster.hpp
+ * The shared, load-once security master every service indexes its state by.
+ */
+#ifndef SECURITY_MASTER_HPP
+#define SECURITY_MASTER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "productregistry.hpp"
+#include "bondanalytics.hpp"
+#include "securitysnapshot.hpp"
+
+/**
+ * Loads the security master once, on first use, from the configured source.
+ * The source is either a TBonds.csv style file or a binary snapshot written by
+ * secmaster_snapshot. A snapshot that cannot be loaded, or is stale (its
+ * analytics are for another settlement date, or the CSV it was compiled from
+ * has changed since), falls back to that CSV, or TBonds.csv if it is gone.
+ * Set the source before anything touches the registry.
+ */
+class SecurityMaster
+{
+
+public:
+
+  static constexpr const char* DEFAULT_CSV = "TBonds.csv";
+
+  // Choose the file to load; has no effect once the registry is loaded
+  static void SetSource(const std::string &filename) {
+    Source() = filename;
+  }
+
+  // Get the registry, loading it on first use
+  static const ProductRegistry& Get() {
+    return Instance().registry;
+  }
+
+  // Get the analytics stored in the snapshot, or nullptr when loaded from CSV
+  static const std::vector<BondAnalytics>* GetPrecomputedAnalytics() {
+    const Loaded &loaded = Instance();
+    return loaded.fromSnapshot ? &loaded.analytics : nullptr;
+  }
+
+  // Get the settlement date analytics should be computed for
+  static const date& GetSettlement() {
+    return Instance().settlement;
+  }
+
+private:
+
+  struct Loaded {
+    ProductRegistry registry;
+    std::vector<BondAnalytics> analytics;
+    date settlement;
+    bool fromSnapshot;
+  };
+
+  static std::string& Source() {
+    static std::string source = DEFAULT_CSV;
+    return source;
+  }
+
+  static const Loaded& Instance() {
+    static const Loaded loaded = Load(Source());
+    return loaded;
+  }
+
+  static Loaded Load(const std::string &source) {
+    if (!IsSecuritySnapshot(source)) {
+      return LoadCsv(source);
+    }
+    SecuritySnapshot snapshot;
+    if (!LoadSecuritySnapshot(source, snapshot)) {
+      std::cerr << "Warning: Falling back to " << DEFAULT_CSV << std::endl;
+      return LoadCsv(DEFAULT_CSV);
+    }
+    std::string csv = snapshot.source;
+    uint64_t csvSize;
+    int64_t csvMtime;
+    bool csvReadable = StatSourceFile(csv, csvSize, csvMtime);
+    if (!csvReadable) {
+      csv = DEFAULT_CSV;
+    }
+    if (snapshot.settlement != BondAnalyticsTable::DefaultSettlement()) {
+      std::cerr << "Warning: Snapshot " << source << " is for settlement " << to_iso_extended_string(snapshot.settlement)
+                << ", not " << to_iso_extended_string(BondAnalyticsTable::DefaultSettlement())
+                << "; falling back to " << csv << std::endl;
+      return LoadCsv(csv);
+    }
+    // Only hash the CSV when its size or modification time has moved, since
+    // reading all of it is the cost the snapshot is there to avoid
+    uint64_t csvHash;
+    if (csvReadable && (csvSize != snapshot.sourceSize || csvMtime != snapshot.sourceMtime) &&
+        (!HashSourceFile(csv, csvHash) || csvHash != snapshot.sourceHash)) {
+      std::cerr << "Warning: " << csv << " has changed since snapshot " << source << " was written; falling back to it" << std::endl;
+      return LoadCsv(csv);
+    }
+    return Loaded{ProductRegistry(std::move(snapshot.bonds), std::move(snapshot.displacements), std::move(snapshot.slots)),
+                  std::move(snapshot.analytics), snapshot.settlement, true};
+  }
+
+  static Loaded LoadCsv(const std::string &csv) {
+    return Loaded{ProductRegistry(LoadBondsFromCsv(csv)), {}, BondAnalyticsTable::DefaultSettlement(), false};
+  }
+
+};
+
+#endif
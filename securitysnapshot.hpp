@@ -0,0 +1,236 @@
+/**
+ * securitysnapshot.hpp
+ * Versioned binary snapshot of the security master: bonds, their CUSIP index
+ * and their analytics, laid out so a loader can map the file and copy it out
+ * without parsing. The layout is native endian and is only read on the kind
+ * of machine that wrote it.
+ */
+#ifndef SECURITY_SNAPSHOT_HPP
+#define SECURITY_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include "products.hpp"
+#include "productregistry.hpp"
+#include "bondanalytics.hpp"
+
+// File layout: SnapshotHeader, productCount SnapshotRecords, displacementCount
+// then slotCount uint32 lookup table entries
+static const char SNAPSHOT_MAGIC[8] = {'S', 'E', 'C', 'M', 'S', 'N', 'A', 'P'};
+static const uint32_t SNAPSHOT_VERSION = 3;
+static const size_t SNAPSHOT_SOURCE_LENGTH = 256;
+
+struct SnapshotHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize;         // sizeof(SnapshotRecord) when written
+  uint32_t productCount;
+  uint32_t displacementCount;
+  uint32_t slotCount;
+  uint32_t settlementDay;      // day number of the date the analytics are for
+  uint64_t fileSize;
+  uint64_t sourceHash;         // HashSourceFile of the CSV the snapshot was compiled from
+  uint64_t sourceSize;         // size and modification time of that CSV, checked before the hash
+  int64_t sourceMtime;         // nanoseconds since the epoch
+  char source[SNAPSHOT_SOURCE_LENGTH];  // path of that CSV, NUL terminated
+};
+
+struct SnapshotRecord
+{
+  char cusip[16];
+  char ticker[16];
+  int32_t idType;
+  float coupon;
+  uint32_t maturityDay;        // boost::gregorian day number
+  uint32_t reserved;
+  BondAnalytics analytics;
+};
+
+// Convert between dates and the day numbers stored in the snapshot
+inline uint32_t ToDayNumber(const date &day) {
+  return day.day_number();
+}
+
+inline date FromDayNumber(uint32_t dayNumber) {
+  gregorian_calendar::ymd_type ymd = gregorian_calendar::from_day_number(dayNumber);
+  return date(ymd.year, ymd.month, ymd.day);
+}
+
+// FNV-1a hash of a file's contents; returns false if it cannot be read
+inline bool HashSourceFile(const std::string &filename, uint64_t &hash) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  hash = 0xcbf29ce484222325ULL;
+  char buffer[65536];
+  while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+    for (std::streamsize i = 0; i < file.gcount(); ++i) {
+      hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 0x100000001b3ULL;
+    }
+  }
+  return true;
+}
+
+// Size and modification time (nanoseconds since the epoch) of a file; returns false if it cannot be stat'ed
+inline bool StatSourceFile(const std::string &filename, uint64_t &size, int64_t &mtime) {
+  struct stat fileStat;
+  if (stat(filename.c_str(), &fileStat) < 0) {
+    return false;
+  }
+  size = fileStat.st_size;
+  mtime = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+  return true;
+}
+
+// Does the file start with the snapshot magic?
+inline bool IsSecuritySnapshot(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  return file.read(magic, sizeof(magic)) && memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+// Write a snapshot of the registry and its analytics, recording the CSV it was
+// loaded from so loaders can tell when it is stale; returns false on I/O error
+inline bool WriteSecuritySnapshot(const std::string &filename, const ProductRegistry &registry, const BondAnalyticsTable &analytics,
+                                  const std::string &source) {
+  const std::vector<Bond> &bonds = registry.GetBonds();
+  const std::vector<uint32_t> &displacements = registry.GetDisplacements();
+  const std::vector<uint32_t> &slots = registry.GetSlots();
+
+  SnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.version = SNAPSHOT_VERSION;
+  header.recordSize = sizeof(SnapshotRecord);
+  header.productCount = bonds.size();
+  header.displacementCount = displacements.size();
+  header.slotCount = slots.size();
+  header.settlementDay = ToDayNumber(analytics.GetSettlement());
+  header.fileSize = sizeof(SnapshotHeader) + bonds.size() * sizeof(SnapshotRecord) +
+    (displacements.size() + slots.size()) * sizeof(uint32_t);
+  if (source.size() >= sizeof(header.source) || !StatSourceFile(source, header.sourceSize, header.sourceMtime) ||
+      !HashSourceFile(source, header.sourceHash)) {
+    std::cerr << "Error: Cannot record snapshot source " << source << std::endl;
+    return false;
+  }
+  memcpy(header.source, source.data(), source.size());
+
+  std::vector<SnapshotRecord> records(bonds.size());
+  for (uint32_t i = 0; i < bonds.size(); ++i) {
+    const Bond &bond = bonds[i];
+    SnapshotRecord &record = records[i];
+    memset(&record, 0, sizeof(record));
+    if (bond.GetTicker().size() >= sizeof(record.ticker)) {
+      std::cerr << "Error: Ticker too long for snapshot: " << bond.GetTicker() << std::endl;
+      return false;
+    }
+    memcpy(record.cusip, bond.GetProductId().data(), bond.GetProductId().size());
+    memcpy(record.ticker, bond.GetTicker().data(), bond.GetTicker().size());
+    record.idType = bond.GetBondIdType();
+    record.coupon = bond.GetCoupon();
+    record.maturityDay = ToDayNumber(bond.GetMaturityDate());
+    record.analytics = analytics.Get(i);
+  }
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(SnapshotRecord));
+  file.write(reinterpret_cast<const char*>(displacements.data()), displacements.size() * sizeof(uint32_t));
+  file.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(uint32_t));
+  return static_cast<bool>(file);
+}
+
+/**
+ * Contents of a snapshot, copied out of the mapped file.
+ */
+struct SecuritySnapshot
+{
+  std::vector<Bond> bonds;
+  std::vector<uint32_t> displacements;
+  std::vector<uint32_t> slots;
+  std::vector<BondAnalytics> analytics;
+  date settlement;
+  std::string source;          // CSV the snapshot was compiled from
+  uint64_t sourceHash;
+  uint64_t sourceSize;
+  int64_t sourceMtime;
+};
+
+// Map a snapshot and copy it into snapshot; returns false (after logging) if it is missing or invalid
+inline bool LoadSecuritySnapshot(const std::string &filename, SecuritySnapshot &snapshot) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    perror(("Failed to open snapshot " + filename).c_str());
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) < 0 || static_cast<size_t>(fileStat.st_size) < sizeof(SnapshotHeader)) {
+    std::cerr << "Error: Snapshot " << filename << " is truncated" << std::endl;
+    close(fd);
+    return false;
+  }
+  size_t length = fileStat.st_size;
+  void *address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    perror("mmap failed");
+    return false;
+  }
+  const char *base = static_cast<const char*>(address);
+
+  SnapshotHeader header;
+  memcpy(&header, base, sizeof(header));
+  bool valid = memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 &&
+    header.version == SNAPSHOT_VERSION && header.recordSize == sizeof(SnapshotRecord) &&
+    header.fileSize == length && header.fileSize == sizeof(SnapshotHeader) +
+      static_cast<uint64_t>(header.productCount) * sizeof(SnapshotRecord) +
+      (static_cast<uint64_t>(header.displacementCount) + header.slotCount) * sizeof(uint32_t);
+  if (!valid) {
+    std::cerr << "Error: " << filename << " is not a version " << SNAPSHOT_VERSION << " security snapshot" << std::endl;
+    munmap(address, length);
+    return false;
+  }
+
+  const SnapshotRecord *records = reinterpret_cast<const SnapshotRecord*>(base + sizeof(SnapshotHeader));
+  const uint32_t *tables = reinterpret_cast<const uint32_t*>(records + header.productCount);
+  snapshot.bonds.clear();
+  snapshot.bonds.reserve(header.productCount);
+  snapshot.analytics.resize(header.productCount);
+  try {
+    for (uint32_t i = 0; i < header.productCount; ++i) {
+      const SnapshotRecord &record = records[i];
+      snapshot.bonds.emplace_back(std::string(record.cusip, strnlen(record.cusip, sizeof(record.cusip))),
+        static_cast<BondIdType>(record.idType), std::string(record.ticker, strnlen(record.ticker, sizeof(record.ticker))),
+        record.coupon, FromDayNumber(record.maturityDay));
+      snapshot.analytics[i] = record.analytics;
+    }
+    snapshot.settlement = FromDayNumber(header.settlementDay);
+    snapshot.source.assign(header.source, strnlen(header.source, sizeof(header.source)));
+    snapshot.sourceHash = header.sourceHash;
+    snapshot.sourceSize = header.sourceSize;
+    snapshot.sourceMtime = header.sourceMtime;
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Error: Bad record in snapshot " << filename << ": " << e.what() << std::endl;
+    munmap(address, length);
+    return false;
+  }
+  snapshot.displacements.assign(tables, tables + header.displacementCount);
+  snapshot.slots.assign(tables + header.displacementCount, tables + header.displacementCount + header.slotCount);
+  munmap(address, length);
+  return true;
+}
+
+#endif
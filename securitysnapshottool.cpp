@@ -0,0 +1,41 @@
+/**
+ * securitysnapshottool.cpp
+ * Compiles a TBonds.csv style security master into a binary snapshot that the
+ * trading system loads with --secmaster, skipping CSV parsing and bond pricing
+ * at startup.
+ * Usage: secmaster_snapshot <bonds.csv> <snapshot> [settlement YYYY-MM-DD]
+ */
+#include <iostream>
+#include <string>
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include "productregistry.hpp"
+#include "bondanalytics.hpp"
+#include "securitysnapshot.hpp"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <bonds.csv> <snapshot> [settlement YYYY-MM-DD]" << std::endl;
+        return 1;
+    }
+
+    try {
+        date settlement = argc == 4 ? from_simple_string(argv[3]) : BondAnalyticsTable::DefaultSettlement();
+        ProductRegistry registry(LoadBondsFromCsv(argv[1]));
+        if (registry.Size() == 0) {
+            std::cerr << "Error: No bonds loaded from " << argv[1] << std::endl;
+            return 1;
+        }
+        BondAnalyticsTable analytics(registry, settlement);
+        if (!WriteSecuritySnapshot(argv[2], registry, analytics, argv[1])) {
+            std::cerr << "Error: Unable to write " << argv[2] << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << registry.Size() << " bonds settling " << to_iso_extended_string(settlement)
+                  << " to " << argv[2] << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
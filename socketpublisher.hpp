@@ -0,0 +1,374 @@
+/**
+ * socketpublisher.hpp
+ * TCP fan-out publisher for outbound connectors. Publish hands a formatted
+ * message to a publisher thread, which accepts clients and writes to them with
+ * epoll and non-blocking sockets, so a slow subscriber never blocks the
+ * pipeline that publishes.
+ */
+#ifndef SOCKET_PUBLISHER_HPP
+#define SOCKET_PUBLISHER_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "lockfreequeue.hpp"
+
+// What to do with a client whose send queue is full
+enum SlowConsumerPolicy
+{
+  DROP_OLDEST,   // discard the oldest unsent message
+  CONFLATE,      // drop the queued message with the same key, else the oldest
+  DISCONNECT     // close the client; Publish waits rather than drop at the handoff
+};
+
+/**
+ * Limits and policy for a SocketPublisher.
+ */
+struct PublisherConfig
+{
+  size_t maxQueuedPerClient = 1024;   // messages waiting per client before the policy applies
+  size_t handoffCapacity = 16384;     // messages waiting for the publisher thread; beyond it Publish
+                                      // drops the message, or waits under DISCONNECT
+  SlowConsumerPolicy policy = DROP_OLDEST;
+};
+
+/**
+ * Publishes messages to every client connected to a TCP port.
+ * Each message is stored once and shared by all client queues. Clients are
+ * written with non-blocking sends; when the kernel buffer is full the rest
+ * waits in the client's queue until epoll reports it writable. A client
+ * whose queue reaches the limit is a slow consumer and is handled by the
+ * configured policy. Clients are not expected to send anything.
+ */
+class SocketPublisher
+{
+
+public:
+
+  static constexpr uint32_t NO_KEY = 0xFFFFFFFF;
+  static constexpr size_t FLUSH_BATCH = 32;
+
+  SocketPublisher(int _port, const PublisherConfig &_config = PublisherConfig()) :
+    port(_port), config(_config), handoff(_config.handoffCapacity), running(true), wakeupPending(false),
+    published(0), handoffDrops(0), handoffWaits(0), clientDrops(0), conflated(0), slowDisconnects(0)
+  {
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listenFd < 0) {
+      perror("Socket creation failed");
+      exit(1);
+    }
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(port);
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
+      perror("Bind failed");
+      exit(1);
+    }
+    if (listen(listenFd, 5) < 0) {
+      perror("Listen failed");
+      exit(1);
+    }
+
+    epollFd = epoll_create1(0);
+    wakeFd = eventfd(0, EFD_NONBLOCK);
+    if (epollFd < 0 || wakeFd < 0) {
+      perror("Publisher setup failed");
+      exit(1);
+    }
+    Watch(listenFd, EPOLLIN, EPOLL_CTL_ADD);
+    Watch(wakeFd, EPOLLIN, EPOLL_CTL_ADD);
+    publisher = std::thread(&SocketPublisher::Run, this);
+  }
+
+  SocketPublisher(const SocketPublisher&) = delete;
+  SocketPublisher& operator=(const SocketPublisher&) = delete;
+
+  // Stop the publisher after one last attempt to send what is queued
+  ~SocketPublisher() {
+    running.store(false, std::memory_order_release);
+    Wake();
+    publisher.join();
+    for (auto &entry : clients) {
+      close(entry.first);
+    }
+    close(wakeFd);
+    close(epollFd);
+    close(listenFd);
+    if (handoffDrops + handoffWaits + clientDrops + conflated + slowDisconnects > 0) {
+      std::cout << "Port " << port << ": " << published << " messages published, " << conflated << " conflated, "
+           << clientDrops << " dropped for slow clients, " << handoffDrops << " dropped at handoff, "
+           << handoffWaits << " waited at handoff, " << slowDisconnects << " slow clients disconnected" << std::endl;
+    }
+  }
+
+  // Queue a message for every connected client; any thread.
+  // Messages with the same key (e.g. a product index) may be conflated.
+  // Under DISCONNECT a full handoff is waited out, since dropping there would
+  // gap the feed for every client, connected or not
+  void Publish(std::string message, uint32_t key = NO_KEY) {
+    Outbound outbound{std::make_shared<const std::string>(std::move(message)), key};
+    if (!handoff.TryPush(std::move(outbound))) {
+      if (config.policy != DISCONNECT) {
+        handoffDrops.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      handoffWaits.fetch_add(1, std::memory_order_relaxed);
+      do {
+        // The publisher thread never blocks on clients, so this is brief
+        Wake();
+        std::this_thread::yield();
+      } while (!handoff.TryPush(std::move(outbound)));
+    }
+    if (!wakeupPending.exchange(true, std::memory_order_acq_rel)) {
+      Wake();
+    }
+  }
+
+private:
+
+  struct Outbound {
+    std::shared_ptr<const std::string> payload;
+    uint32_t key;
+  };
+
+  struct Client {
+    std::deque<Outbound> queue;
+    size_t offset = 0;          // bytes of the front message already sent
+    bool waitingWritable = false;
+    bool slow = false;          // queue reached the limit since it last drained
+    size_t slowEpisodes = 0;
+  };
+
+  int port;
+  PublisherConfig config;
+  int listenFd;
+  int epollFd;
+  int wakeFd;
+  MpscQueue<Outbound> handoff;
+  std::thread publisher;
+  std::atomic<bool> running;
+  std::atomic<bool> wakeupPending;
+  std::unordered_map<int, Client> clients;  // publisher thread only
+  size_t published;
+  std::atomic<size_t> handoffDrops;
+  std::atomic<size_t> handoffWaits;
+  size_t clientDrops;
+  size_t conflated;
+  size_t slowDisconnects;
+
+  void Watch(int fd, uint32_t events, int operation) {
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, operation, fd, &event);
+  }
+
+  void Wake() {
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+  }
+
+  void Run() {
+    epoll_event events[64];
+    while (true) {
+      int count = epoll_wait(epollFd, events, 64, 100);
+      for (int i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == listenFd) {
+          AcceptClients();
+        }
+        else if (fd == wakeFd) {
+          uint64_t value;
+          ssize_t drained = read(wakeFd, &value, sizeof(value));
+          (void)drained;
+        }
+        else {
+          HandleClient(fd, events[i].events);
+        }
+      }
+      bool stopping = !running.load(std::memory_order_acquire);
+      wakeupPending.store(false, std::memory_order_release);
+      DrainHandoff();
+      if (stopping) {
+        break;
+      }
+    }
+  }
+
+  void AcceptClients() {
+    while (true) {
+      int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+      if (clientFd < 0) {
+        return;
+      }
+      int noDelay = 1;
+      setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+      clients[clientFd];
+      Watch(clientFd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+    }
+  }
+
+  void HandleClient(int fd, uint32_t events) {
+    auto it = clients.find(fd);
+    if (it == clients.end()) {
+      return;
+    }
+    if (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+      CloseClient(it);
+      return;
+    }
+    if (events & EPOLLIN) {
+      // Nothing is expected from clients; discard it and notice closed connections
+      char discard[512];
+      ssize_t received = recv(fd, discard, sizeof(discard), 0);
+      if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        CloseClient(it);
+        return;
+      }
+    }
+    if (events & EPOLLOUT) {
+      Flush(it);
+    }
+  }
+
+  void DrainHandoff() {
+    while (handoff.TryConsume([this](Outbound &outbound) {
+      published++;
+      for (auto it = clients.begin(); it != clients.end();) {
+        auto current = it++;
+        Enqueue(current->second, outbound);
+        // Keep up with a burst instead of queueing all of it; clients the
+        // kernel will not take more from wait for EPOLLOUT instead
+        if (!current->second.waitingWritable && current->second.queue.size() >= FLUSH_BATCH) {
+          Flush(current);
+        }
+      }
+    })) {
+    }
+    for (auto it = clients.begin(); it != clients.end();) {
+      auto current = it++;
+      if (current->second.slow && config.policy == DISCONNECT) {
+        std::cerr << "Disconnecting slow client on port " << port << std::endl;
+        slowDisconnects++;
+        CloseClient(current);
+      }
+      else if (!current->second.queue.empty() && !current->second.waitingWritable) {
+        Flush(current);
+      }
+    }
+  }
+
+  // Add a message to a client's queue, applying the policy if it is full
+  void Enqueue(Client &client, const Outbound &outbound) {
+    if (client.slow && config.policy == DISCONNECT) {
+      return;
+    }
+    // Only clients the kernel has stopped taking data from are conflated. The
+    // front message may be partly sent, so it is never replaced or dropped.
+    // The superseded message is removed and the new one appended, so messages
+    // still leave in publish order (sequence numbers never go backwards)
+    if (config.policy == CONFLATE && client.waitingWritable && outbound.key != NO_KEY && client.queue.size() > 1) {
+      for (auto it = client.queue.begin() + 1; it != client.queue.end(); ++it) {
+        if (it->key == outbound.key) {
+          client.queue.erase(it);
+          client.queue.push_back(outbound);
+          conflated++;
+          return;
+        }
+      }
+    }
+    if (client.queue.size() >= config.maxQueuedPerClient) {
+      if (!client.slow) {
+        // Reported once per client; later episodes only show in the drop counts
+        if (client.slowEpisodes++ == 0) {
+          std::cerr << "Slow client on port " << port << ": " << client.queue.size() << " messages queued" << std::endl;
+        }
+        client.slow = true;
+      }
+      if (config.policy == DISCONNECT || client.queue.size() < 2) {
+        clientDrops++;
+        return;
+      }
+      client.queue.erase(client.queue.begin() + 1);
+      clientDrops++;
+    }
+    client.queue.push_back(outbound);
+  }
+
+  // Write as much of a client's queue as the socket takes without blocking
+  void Flush(std::unordered_map<int, Client>::iterator it) {
+    int fd = it->first;
+    Client &client = it->second;
+    while (!client.queue.empty()) {
+      iovec buffers[64];
+      int bufferCount = 0;
+      for (auto message = client.queue.begin(); message != client.queue.end() && bufferCount < 64; ++message) {
+        const std::string &payload = *message->payload;
+        size_t skip = bufferCount == 0 ? client.offset : 0;
+        buffers[bufferCount].iov_base = const_cast<char*>(payload.data() + skip);
+        buffers[bufferCount].iov_len = payload.size() - skip;
+        bufferCount++;
+      }
+      msghdr header{};
+      header.msg_iov = buffers;
+      header.msg_iovlen = bufferCount;
+      ssize_t sent = sendmsg(fd, &header, MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          break;
+        }
+        CloseClient(it);
+        return;
+      }
+      size_t remaining = sent;
+      while (remaining > 0) {
+        size_t frontLeft = client.queue.front().payload->size() - client.offset;
+        if (remaining < frontLeft) {
+          client.offset += remaining;
+          break;
+        }
+        remaining -= frontLeft;
+        client.offset = 0;
+        client.queue.pop_front();
+      }
+    }
+    if (client.queue.empty()) {
+      client.slow = false;
+    }
+    bool waitWritable = !client.queue.empty();
+    if (waitWritable != client.waitingWritable) {
+      client.waitingWritable = waitWritable;
+      Watch(fd, EPOLLIN | EPOLLRDHUP | (waitWritable ? EPOLLOUT : 0u), EPOLL_CTL_MOD);
+    }
+  }
+
+  void CloseClient(std::unordered_map<int, Client>::iterator it) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, it->first, nullptr);
+    close(it->first);
+    clients.erase(it);
+  }
+
+};
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * staticdispatch.hpp
+ * Compile-time listener lists for fixed pipeline topologies.
+ * A service that holds a StaticListenerList by value calls each listener with a
+ * qualified, non-virtual call, so the compiler can inline the listener into the
+ * service's OnMessage. Services keep their dynamic AddListener for listeners
+ * that are only known at run time.
+ */
+#ifndef STATIC_DISPATCH_HPP
+#define STATIC_DISPATCH_HPP
+
+#include <tuple>
+#include "soa.hpp"
+
+/**
+ * Fixed list of listeners on a Service, resolved at compile time.
+ * Each listener type must implement ProcessAdd, ProcessRemove and ProcessUpdate
+ * for V. Listeners are called in the order of the template arguments. The list is
+ * also a ServiceListener itself, so it can be registered dynamically and still
+ * cost only one virtual call for the whole group.
+ * Bind the listeners before the service receives data.
+ */
+template<typename V, typename... Listeners>
+class StaticListenerList final : public ServiceListener<V>
+{
+
+public:
+
+  // ctor for an unbound list
+  StaticListenerList() : listeners() {}
+
+  // ctor for a list bound to the given listeners
+  explicit StaticListenerList(Listeners*... _listeners) : listeners(_listeners...) {}
+
+  // Bind the list to the given listeners
+  void Bind(Listeners*... _listeners) {
+    listeners = std::tuple<Listeners*...>(_listeners...);
+  }
+
+  void ProcessAdd(V &data) override {
+    std::apply([&data](Listeners*... listener) { (listener->Listeners::ProcessAdd(data), ...); }, listeners);
+  }
+
+  void ProcessRemove(V &data) override {
+    std::apply([&data](Listeners*... listener) { (listener->Listeners::ProcessRemove(data), ...); }, listeners);
+  }
+
+  void ProcessUpdate(V &data) override {
+    std::apply([&data](Listeners*... listener) { (listener->Listeners::ProcessUpdate(data), ...); }, listeners);
+  }
+
+private:
+  std::tuple<Listeners*...> listeners;
+
+};
+
+// Empty list for services that only use dynamic listeners
+template<typename V>
+using NoStaticListeners = StaticListenerList<V>;
+
+#endif
@@ -20,13 +20,13 @@ class PriceStreamOrder
 public:
 
   // ctor for an order
-  PriceStreamOrder(double _price, long _visibleQuantity, long _hiddenQuantity, PricingSide _side);
+  PriceStreamOrder(TreasuryPrice _price, long _visibleQuantity, long _hiddenQuantity, PricingSide _side);
 
   // The side on this order
   PricingSide GetSide() const;
 
   // Get the price on this order
-  double GetPrice() const;
+  TreasuryPrice GetPrice() const;
 
   // Get the visible quantity on this order
   long GetVisibleQuantity() const;
@@ -40,7 +40,7 @@ public:
   }
 
 private:
-  double price;
+  TreasuryPrice price;
   long visibleQuantity;
   long hiddenQuantity;
   PricingSide side;
@@ -70,11 +70,11 @@ public:
   const PriceStreamOrder& GetOfferOrder() const;
 
   string to_string() const {
-    return product.GetProductId() + "," + bidOrder.to_string() + "," + offerOrder.to_string();
+    return product->GetProductId() + "," + bidOrder.to_string() + "," + offerOrder.to_string();
   }
 
 private:
-  T product;
+  const T* product;  // points into the product registry
   PriceStreamOrder bidOrder;
   PriceStreamOrder offerOrder;
 
@@ -96,7 +96,7 @@ public:
 
 };
 
-PriceStreamOrder::PriceStreamOrder(double _price, long _visibleQuantity, long _hiddenQuantity, PricingSide _side)
+PriceStreamOrder::PriceStreamOrder(TreasuryPrice _price, long _visibleQuantity, long _hiddenQuantity, PricingSide _side)
 {
   price = _price;
   visibleQuantity = _visibleQuantity;
@@ -104,7 +104,7 @@ PriceStreamOrder::PriceStreamOrder(double _price, long _visibleQuantity, long _h
   side = _side;
 }
 
-double PriceStreamOrder::GetPrice() const
+TreasuryPrice PriceStreamOrder::GetPrice() const
 {
   return price;
 }
@@ -121,14 +121,14 @@ long PriceStreamOrder::GetHiddenQuantity() const
 
 template<typename T>
 PriceStream<T>::PriceStream(const T &_product, const PriceStreamOrder &_bidOrder, const PriceStreamOrder &_offerOrder) :
-  product(_product), bidOrder(_bidOrder), offerOrder(_offerOrder)
+  product(&_product), bidOrder(_bidOrder), offerOrder(_offerOrder)
 {
 }
 
 template<typename T>
 const T& PriceStream<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
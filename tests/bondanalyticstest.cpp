@@ -0,0 +1,67 @@
+/**
+ * bondanalyticstest.cpp
+ * Coupon schedules and pricing of matured bonds.
+ */
+#include "testcheck.hpp"
+#include "bondanalytics.hpp"
+
+// An 8/30 maturity pays on 2/28 (2/29 in leap years) and 8/30, never 8/31
+void TestMidMonthMaturityDoesNotDrift() {
+  CouponSchedule schedule = BuildCouponSchedule(date(2030, Aug, 30), date(2024, Dec, 2));
+  CHECK_EQUAL(schedule.previousCoupon, date(2024, Aug, 30));
+  CHECK_EQUAL(schedule.nextCoupon, date(2025, Feb, 28));
+  CHECK_EQUAL(schedule.remainingCoupons, 12);
+
+  schedule = BuildCouponSchedule(date(2030, Aug, 30), date(2028, Mar, 15));
+  CHECK_EQUAL(schedule.previousCoupon, date(2028, Feb, 29));
+  CHECK_EQUAL(schedule.nextCoupon, date(2028, Aug, 30));
+}
+
+// Month end maturities stay on month ends
+void TestMonthEndMaturity() {
+  CouponSchedule schedule = BuildCouponSchedule(date(2030, Aug, 31), date(2024, Dec, 2));
+  CHECK_EQUAL(schedule.previousCoupon, date(2024, Aug, 31));
+  CHECK_EQUAL(schedule.nextCoupon, date(2025, Feb, 28));
+
+  schedule = BuildCouponSchedule(date(2026, Nov, 30), date(2024, Dec, 2));
+  CHECK_EQUAL(schedule.previousCoupon, date(2024, Nov, 30));
+  CHECK_EQUAL(schedule.nextCoupon, date(2025, May, 31));
+  CHECK_EQUAL(schedule.remainingCoupons, 4);
+  CHECK(schedule.accruedFraction > 0.0 && schedule.accruedFraction < 0.02);
+}
+
+// Settlement on a coupon date accrues nothing
+void TestSettlementOnCouponDate() {
+  CouponSchedule schedule = BuildCouponSchedule(date(2030, Aug, 30), date(2029, Aug, 30));
+  CHECK_EQUAL(schedule.previousCoupon, date(2029, Aug, 30));
+  CHECK_EQUAL(schedule.remainingCoupons, 2);
+  CHECK_EQUAL(schedule.accruedFraction, 0.0);
+}
+
+// A matured bond has no coupons and zero analytics instead of failing the table
+void TestMaturedBond() {
+  CouponSchedule schedule = BuildCouponSchedule(date(2024, Nov, 30), date(2024, Dec, 2));
+  CHECK_EQUAL(schedule.remainingCoupons, 0);
+  BondAnalytics analytics = PriceBond(0.04, schedule, 0.04);
+  CHECK_EQUAL(analytics.dirtyPrice, 0.0);
+  CHECK_EQUAL(analytics.dv01, 0.0);
+
+  ProductRegistry registry({Bond("MATURED01", CUSIP, "T0Y", 0.04f, date(2024, Dec, 2)),
+                            Bond("LIVE00001", CUSIP, "T2Y", 0.04f, date(2026, Nov, 30))});
+  BondAnalyticsTable table(registry, date(2024, Dec, 2));
+  uint32_t matured = registry.Find("MATURED01");
+  uint32_t live = registry.Find("LIVE00001");
+  CHECK(table.IsMatured(matured));
+  CHECK(!table.IsMatured(live));
+  CHECK_EQUAL(table.GetDV01(matured), 0.0);
+  CHECK(table.GetDV01(live) > 0.0);
+  CHECK(std::fabs(table.Get(live).cleanPrice - 100.0) < 0.001);  // par, up to the fractional period
+}
+
+int main() {
+  TestMidMonthMaturityDoesNotDrift();
+  TestMonthEndMaturity();
+  TestSettlementOnCouponDate();
+  TestMaturedBond();
+  return TestResult();
+}
@@ -0,0 +1,140 @@
+/**
+ * fieldparsertest.cpp
+ * Field and record parsers for the price, market data, trade and inquiry feeds.
+ */
+#include <string>
+#include "testcheck.hpp"
+#include "fieldparser.hpp"
+
+// Fields are split on commas and trimmed of blanks and a trailing CR
+void TestFieldCursor() {
+  FieldCursor cursor(" a ,b,\t, c \r");
+  std::string_view field;
+  CHECK(cursor.Next(field) && field == "a");
+  CHECK(cursor.Next(field) && field == "b");
+  CHECK(cursor.Next(field) && field.empty());
+  CHECK(cursor.HasMore());
+  CHECK(cursor.Next(field) && field == "c");
+  CHECK(!cursor.HasMore());
+  CHECK(!cursor.Next(field));
+}
+
+void TestNumbers() {
+  long value = -1;
+  CHECK_EQUAL(ParseUnsigned("0", value), PARSE_OK);
+  CHECK_EQUAL(value, 0);
+  CHECK_EQUAL(ParseUnsigned("123456789012345678", value), PARSE_OK);
+  CHECK_EQUAL(ParseUnsigned("1234567890123456789", value), PARSE_BAD_NUMBER);
+  CHECK_EQUAL(ParseUnsigned("", value), PARSE_BAD_NUMBER);
+  CHECK_EQUAL(ParseUnsigned("-1", value), PARSE_BAD_NUMBER);
+  CHECK_EQUAL(ParseUnsigned("12a", value), PARSE_BAD_NUMBER);
+
+  double decimal = 0.0;
+  CHECK_EQUAL(ParseDecimal("99.5", decimal), PARSE_OK);
+  CHECK_EQUAL(decimal, 99.5);
+  CHECK_EQUAL(ParseDecimal("100", decimal), PARSE_OK);
+  CHECK_EQUAL(decimal, 100.0);
+  CHECK_EQUAL(ParseDecimal("99.x", decimal), PARSE_BAD_NUMBER);
+  CHECK_EQUAL(ParseDecimal(".5", decimal), PARSE_BAD_NUMBER);
+
+  long quantity = 0;
+  CHECK_EQUAL(ParseQuantity("10M", quantity), PARSE_OK);
+  CHECK_EQUAL(quantity, 10000000);
+  CHECK_EQUAL(ParseQuantity("250k", quantity), PARSE_OK);
+  CHECK_EQUAL(quantity, 250000);
+  CHECK_EQUAL(ParseQuantity("500", quantity), PARSE_OK);
+  CHECK_EQUAL(quantity, 500);
+  CHECK_EQUAL(ParseQuantity("9223372036854M", quantity), PARSE_OK);
+  CHECK_EQUAL(quantity, 9223372036854000000);
+  CHECK_EQUAL(ParseQuantity("9223372036855M", quantity), PARSE_BAD_QUANTITY);
+  CHECK_EQUAL(ParseQuantity("999999999999999M", quantity), PARSE_BAD_QUANTITY);
+  CHECK_EQUAL(ParseQuantity("999999999999999999K", quantity), PARSE_BAD_QUANTITY);
+  CHECK_EQUAL(ParseQuantity("M", quantity), PARSE_BAD_QUANTITY);
+  CHECK_EQUAL(ParseQuantity("10G", quantity), PARSE_BAD_QUANTITY);
+}
+
+void TestCusipAndSides() {
+  std::string_view cusip;
+  CHECK_EQUAL(ParseCusip("91282CLY5", cusip), PARSE_OK);
+  CHECK(cusip == "91282CLY5");
+  CHECK_EQUAL(ParseCusip("91282CLY", cusip), PARSE_BAD_CUSIP);
+  CHECK_EQUAL(ParseCusip("91282cly5", cusip), PARSE_BAD_CUSIP);
+
+  Side side;
+  PricingSide pricingSide;
+  CHECK_EQUAL(ParseSide("1", side), PARSE_OK);
+  CHECK_EQUAL(side, SELL);
+  CHECK_EQUAL(ParseSide("2", side), PARSE_BAD_SIDE);
+  CHECK_EQUAL(ParsePricingSide("0", pricingSide), PARSE_OK);
+  CHECK_EQUAL(pricingSide, BID);
+  CHECK_EQUAL(ParsePricingSide("01", pricingSide), PARSE_BAD_SIDE);
+}
+
+void TestPriceRecord() {
+  PriceRecord record;
+  CHECK_EQUAL(ParsePriceRecord("91282CLY5, 099-16+, 1\r", record), PARSE_OK);
+  CHECK(record.cusip == "91282CLY5");
+  CHECK_EQUAL(record.mid.Ticks(), TreasuryPrice::FromFraction(99, 16, 4).Ticks());
+  CHECK_EQUAL(record.bidOfferSpread.Ticks(), 2);
+  CHECK_EQUAL(ParsePriceRecord("", record), PARSE_TOO_SHORT);
+  CHECK_EQUAL(ParsePriceRecord("91282CLY5, 099-16+", record), PARSE_MISSING_FIELD);
+  CHECK_EQUAL(ParsePriceRecord("91282CLY5, 099-32+, 1", record), PARSE_BAD_PRICE);
+  CHECK_EQUAL(ParsePriceRecord("91282CLY5, 099-16+, x", record), PARSE_BAD_NUMBER);
+  CHECK_EQUAL(ParsePriceRecord("91282CLY5, 099-16+, 1, 2", record), PARSE_EXTRA_FIELD);
+}
+
+void TestOrderBookRecord() {
+  OrderBookRecord record;
+  CHECK_EQUAL(ParseOrderBookRecord("91282CLY5, 0, 098-317, 10M, 1, 099-001, 20M", record), PARSE_OK);
+  CHECK_EQUAL(record.levelCount, 2u);
+  CHECK_EQUAL(record.levels[0].side, BID);
+  CHECK_EQUAL(record.levels[0].price.Ticks(), TreasuryPrice::FromFraction(98, 31, 7).Ticks());
+  CHECK_EQUAL(record.levels[1].quantity, 20000000);
+  CHECK_EQUAL(ParseOrderBookRecord("91282CLY5", record), PARSE_TOO_SHORT);
+  CHECK_EQUAL(ParseOrderBookRecord("91282CLY5, 0, 098-317", record), PARSE_MISSING_FIELD);
+  CHECK_EQUAL(ParseOrderBookRecord("91282CLY5, 2, 098-317, 10M", record), PARSE_BAD_SIDE);
+
+  std::string tooDeep = "91282CLY5";
+  for (size_t i = 0; i <= OrderBookRecord::MAX_LEVELS; ++i) {
+    tooDeep += ", 0, 098-317, 10M";
+  }
+  CHECK_EQUAL(ParseOrderBookRecord(tooDeep, record), PARSE_TOO_MANY_LEVELS);
+}
+
+void TestTradeRecord() {
+  TradeRecord record;
+  CHECK_EQUAL(ParseTradeRecord("91282CLY5, AAAAAA,  99, TRSY1, 1000000, 0", record), PARSE_OK);
+  CHECK(record.tradeId == "AAAAAA");
+  CHECK(record.book == "TRSY1");
+  CHECK_EQUAL(record.price.Ticks(), TreasuryPrice::FromPoints(99).Ticks());
+  CHECK_EQUAL(record.quantity, 1000000);
+  CHECK_EQUAL(record.side, BUY);
+  CHECK_EQUAL(ParseTradeRecord("91282CLY5, AAAAAB, 99-16+, TRSY2, 2M, 1", record), PARSE_OK);
+  CHECK_EQUAL(record.price.Ticks(), TreasuryPrice::FromFraction(99, 16, 4).Ticks());
+  CHECK_EQUAL(record.side, SELL);
+  CHECK_EQUAL(ParseTradeRecord("91282CLY5, , 99, TRSY1, 1, 0", record), PARSE_MISSING_FIELD);
+  CHECK_EQUAL(ParseTradeRecord("91282CLY5, A, 99, , 1, 0", record), PARSE_MISSING_FIELD);
+  CHECK_EQUAL(ParseTradeRecord("91282CLY5, A, 99-1, TRSY1, 1, 0", record), PARSE_BAD_PRICE);
+  CHECK_EQUAL(ParseTradeRecord("91282CLY5, A, 99, TRSY1, 1, 0, 0", record), PARSE_EXTRA_FIELD);
+}
+
+void TestInquiryRecord() {
+  InquiryRecord record;
+  CHECK_EQUAL(ParseInquiryRecord("000001, 91282CLY5, 0, 500", record), PARSE_OK);
+  CHECK(record.inquiryId == "000001");
+  CHECK(record.cusip == "91282CLY5");
+  CHECK_EQUAL(record.quantity, 500);
+  CHECK_EQUAL(ParseInquiryRecord("000001, 91282CLY5, 0", record), PARSE_MISSING_FIELD);
+  CHECK_EQUAL(ParseInquiryRecord("000001, 91282CLY, 0, 500", record), PARSE_BAD_CUSIP);
+}
+
+int main() {
+  TestFieldCursor();
+  TestNumbers();
+  TestCusipAndSides();
+  TestPriceRecord();
+  TestOrderBookRecord();
+  TestTradeRecord();
+  TestInquiryRecord();
+  return TestResult();
+}
@@ -0,0 +1,77 @@
+/**
+ * orderbooktest.cpp
+ * OrderBook keeps each side in price order, so best level and top-N queries
+ * do not depend on the order the levels arrive in.
+ */
+#include "testcheck.hpp"
+#include "products.hpp"
+#include "marketdataservice.hpp"
+
+static const Bond bond("91282CLY5", CUSIP, "US2Y", 0.04f, date(2026, Nov, 30));
+
+TreasuryPrice Price(int handle, int thirtySeconds) {
+  return TreasuryPrice::FromFraction(handle, thirtySeconds, 0);
+}
+
+void TestOutOfOrderLevels() {
+  OrderBook<Bond> book(bond);
+  CHECK(book.AddLevel(BID, Price(99, 0), 30));
+  CHECK(book.AddLevel(BID, Price(99, 2), 10));
+  CHECK(book.AddLevel(BID, Price(98, 30), 40));
+  CHECK(book.AddLevel(BID, Price(99, 1), 20));
+  CHECK(book.AddLevel(OFFER, Price(99, 5), 30));
+  CHECK(book.AddLevel(OFFER, Price(99, 3), 10));
+  CHECK(book.AddLevel(OFFER, Price(99, 4), 20));
+
+  // Bids descending, offers ascending
+  CHECK_EQUAL(book.GetBidDepth(), 4u);
+  CHECK_EQUAL(book.GetBid(0).GetPrice().Ticks(), Price(99, 2).Ticks());
+  CHECK_EQUAL(book.GetBid(1).GetPrice().Ticks(), Price(99, 1).Ticks());
+  CHECK_EQUAL(book.GetBid(2).GetPrice().Ticks(), Price(99, 0).Ticks());
+  CHECK_EQUAL(book.GetBid(3).GetPrice().Ticks(), Price(98, 30).Ticks());
+  CHECK_EQUAL(book.GetOffer(0).GetPrice().Ticks(), Price(99, 3).Ticks());
+  CHECK_EQUAL(book.GetOffer(2).GetPrice().Ticks(), Price(99, 5).Ticks());
+
+  BidOffer best = book.GetBestBidOffer();
+  CHECK_EQUAL(best.GetBidOrder().GetQuantity(), 10);
+  CHECK_EQUAL(best.GetOfferOrder().GetQuantity(), 10);
+
+  // Top two by price, not the first two received
+  CHECK_EQUAL(book.GetCumulativeBidSize(2), 30);
+  CHECK_EQUAL(book.GetCumulativeOfferSize(2), 30);
+  CHECK_EQUAL(book.GetCumulativeBidSize(), 100);
+  double mid = (Price(99, 2).ToDecimal() * 10 + Price(99, 3).ToDecimal() * 10) / 20;
+  CHECK_EQUAL(book.GetDepthWeightedMid(1), mid);
+}
+
+void TestEqualPricesAndMerge() {
+  OrderBook<Bond> book(bond);
+  CHECK(book.AddLevel(OFFER, Price(99, 4), 1));
+  CHECK(book.AddLevel(OFFER, Price(99, 4), 2));
+  CHECK(book.MergeLevel(OFFER, Price(99, 3), 5));
+  CHECK(book.MergeLevel(OFFER, Price(99, 3), 5));
+
+  // Equal prices keep arrival order; merged quantity lands on the existing level
+  CHECK_EQUAL(book.GetOfferDepth(), 3u);
+  CHECK_EQUAL(book.GetOffer(0).GetQuantity(), 10);
+  CHECK_EQUAL(book.GetOffer(1).GetQuantity(), 1);
+  CHECK_EQUAL(book.GetOffer(2).GetQuantity(), 2);
+  CHECK_EQUAL(book.BestOfferLevel(), 0u);
+  CHECK_EQUAL(book.BestBidLevel(), OrderBook<Bond>::MAX_DEPTH);
+}
+
+void TestFullSide() {
+  OrderBook<Bond> book(bond);
+  for (size_t i = 0; i < OrderBook<Bond>::MAX_DEPTH; ++i) {
+    CHECK(book.AddLevel(BID, Price(98, static_cast<int>(i)), 1));
+  }
+  CHECK(!book.AddLevel(BID, Price(99, 0), 1));
+  CHECK_EQUAL(book.GetBid(0).GetPrice().Ticks(), Price(98, 7).Ticks());
+}
+
+int main() {
+  TestOutOfOrderLevels();
+  TestEqualPricesAndMerge();
+  TestFullSide();
+  return TestResult();
+}
@@ -0,0 +1,44 @@
+/**
+ * testcheck.hpp
+ * Minimal checks for the unit tests: each failed CHECK prints its location
+ * and the test exits non-zero from TestResult().
+ */
+#ifndef TEST_CHECK_HPP
+#define TEST_CHECK_HPP
+
+#include <iostream>
+
+inline int& TestFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition << std::endl; \
+      TestFailures()++; \
+    } \
+  } while (0)
+
+#define CHECK_EQUAL(actual, expected) \
+  do { \
+    auto actualValue = (actual); \
+    auto expectedValue = (expected); \
+    if (!(actualValue == expectedValue)) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQUAL failed: " #actual " is " << actualValue \
+                << ", expected " << expectedValue << std::endl; \
+      TestFailures()++; \
+    } \
+  } while (0)
+
+// Exit code for main
+inline int TestResult() {
+  if (TestFailures() > 0) {
+    std::cerr << TestFailures() << " checks failed" << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+#endif
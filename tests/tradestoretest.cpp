@@ -0,0 +1,46 @@
+/**
+ * tradestoretest.cpp
+ * TradeStore keeps the most recent trades of a product and finds them by ID.
+ */
+#include <string>
+#include "testcheck.hpp"
+#include "tradebookingservice.hpp"
+
+static const Bond bond("91282CLY5", CUSIP, "US2Y", 0.04f, date(2026, Nov, 30));
+
+Trade<Bond> MakeTrade(const std::string &tradeId, long quantity) {
+  return Trade<Bond>(bond, tradeId, TreasuryPrice::FromPoints(99), "TRSY1", quantity, BUY);
+}
+
+void TestEviction() {
+  TradeStore<Bond> store(3);
+  for (int i = 1; i <= 5; ++i) {
+    store.Add(MakeTrade("T" + std::to_string(i), i));
+  }
+  CHECK_EQUAL(store.Size(), 3u);
+  CHECK_EQUAL(store.Evicted(), 2u);
+  CHECK(store.Find("T1") == nullptr);
+  CHECK(store.Find("T2") == nullptr);
+  CHECK(store.Find("T3") != nullptr);
+  CHECK_EQUAL(store.Find("T5")->GetQuantity(), 5);
+}
+
+void TestReusedId() {
+  TradeStore<Bond> store(2);
+  store.Add(MakeTrade("A", 1));
+  store.Add(MakeTrade("A", 2));
+  CHECK_EQUAL(store.Find("A")->GetQuantity(), 2);
+
+  // Evicting the older copy keeps the newer one findable
+  store.Add(MakeTrade("B", 3));
+  CHECK_EQUAL(store.Find("A")->GetQuantity(), 2);
+  store.Add(MakeTrade("C", 4));
+  CHECK(store.Find("A") == nullptr);
+  CHECK_EQUAL(store.Find("B")->GetQuantity(), 3);
+}
+
+int main() {
+  TestEviction();
+  TestReusedId();
+  return TestResult();
+}
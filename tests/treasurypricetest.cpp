@@ -0,0 +1,85 @@
+/**
+ * treasurypricetest.cpp
+ * TreasuryPrice parsing and formatting at the edges of the fractional notation.
+ */
+#include <string>
+#include "testcheck.hpp"
+#include "treasuryprice.hpp"
+#include "helperfunction.hpp"
+
+struct FormatCase
+{
+  int64_t ticks;
+  const char* text;
+};
+
+// Parse and Format are inverses over valid prices
+void TestRoundTrip() {
+  const FormatCase cases[] = {
+    {0, "0-000"},
+    {4, "0-00+"},
+    {7, "0-007"},
+    {8, "0-010"},
+    {255, "0-317"},
+    {256, "1-000"},
+    {99 * 256 + 16 * 8 + 4, "99-16+"},
+    {100 * 256, "100-000"},
+    {999 * 256 + 31 * 8 + 4, "999-31+"},
+    {999 * 256 + 255, "999-317"},
+  };
+  for (const FormatCase &c : cases) {
+    TreasuryPrice price = TreasuryPrice::FromTicks(c.ticks);
+    CHECK_EQUAL(price.ToString(), std::string(c.text));
+    TreasuryPrice parsed;
+    CHECK(TreasuryPrice::Parse(c.text, parsed));
+    CHECK_EQUAL(parsed.Ticks(), c.ticks);
+  }
+}
+
+// Malformed handles, 32nds and 256ths digits are rejected
+void TestParseRejects() {
+  const char* bad[] = {
+    "", "-", "99", "99-", "99-1", "99-16", "99-16++", "-16+", "1000-000",
+    "99-32+", "99-40+", "99-3a0", "99-168", "99-169", "99-16-", "9a-160", " 99-160", "99-160 ",
+  };
+  for (const char* text : bad) {
+    TreasuryPrice parsed = TreasuryPrice::FromTicks(12345);
+    CHECK(!TreasuryPrice::Parse(text, parsed));
+    CHECK_EQUAL(parsed.Ticks(), 12345);
+  }
+}
+
+// Negative prices floor toward the lower handle, so the suffix stays in 0-317
+void TestNegativeTicks() {
+  CHECK_EQUAL(TreasuryPrice::FromTicks(-1).ToString(), std::string("-1-317"));
+  CHECK_EQUAL(TreasuryPrice::FromTicks(-256).ToString(), std::string("-1-000"));
+  CHECK_EQUAL(TreasuryPrice::FromTicks(-257).ToString(), std::string("-2-317"));
+  CHECK_EQUAL((TreasuryPrice::FromPoints(99) - TreasuryPrice::FromPoints(100)).Ticks(), -256);
+}
+
+// Extreme tick counts fit MAX_LENGTH
+void TestLimits() {
+  char buffer[TreasuryPrice::MAX_LENGTH];
+  CHECK(TreasuryPrice::Lowest().Format(buffer) <= TreasuryPrice::MAX_LENGTH);
+  CHECK(TreasuryPrice::Highest().Format(buffer) <= TreasuryPrice::MAX_LENGTH);
+  CHECK(TreasuryPrice::Lowest() < TreasuryPrice::FromTicks(0));
+  CHECK(TreasuryPrice::Highest() > TreasuryPrice::FromPoints(1000));
+}
+
+// Decimal conversions and the helper formatters
+void TestConversions() {
+  CHECK_EQUAL(TreasuryPrice::FromDecimal(99.515625).Ticks(), 99 * 256 + 132);
+  CHECK_EQUAL(TreasuryPrice::FromFraction(99, 16, 4).ToDecimal(), 99.515625);
+  CHECK_EQUAL(convert_to_fractional(TreasuryPrice::FromFraction(99, 16, 4)), std::string("99-16+"));
+  CHECK_EQUAL(convert_to_256th(TreasuryPrice::FromTicks(2)), std::string("2/256"));
+  CHECK_EQUAL(convert_to_256th(TreasuryPrice::FromTicks(-2)), std::string("-2/256"));
+}
+
+int main() {
+  TestRoundTrip();
+  TestParseRejects();
+  TestNegativeTicks();
+  TestLimits();
+  TestConversions();
+  return TestResult();
+}
@@ -0,0 +1,39 @@
+/**
+ * tscclocktest.cpp
+ * TscClock readings are monotonic and convert to nanoseconds close to steady_clock.
+ */
+#include <chrono>
+#include <thread>
+#include "testcheck.hpp"
+#include "timestampformatter.hpp"
+
+void TestMonotonic() {
+  uint64_t previous = TscClock::Now();
+  for (int i = 0; i < 100000; ++i) {
+    uint64_t now = TscClock::Now();
+    CHECK(now >= previous);
+    previous = now;
+  }
+}
+
+void TestNanoseconds() {
+  CHECK(TscClock::TicksPerNanosecond() > 0.0);
+  CHECK_EQUAL(TscClock::ToNanoseconds(0), 0.0);
+
+  // A sleep measured both ways should agree to well within the sleep itself
+  auto wallStart = std::chrono::steady_clock::now();
+  uint64_t tickStart = TscClock::Now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  uint64_t tickEnd = TscClock::Now();
+  auto wallEnd = std::chrono::steady_clock::now();
+  double wall = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(wallEnd - wallStart).count());
+  double measured = TscClock::ToNanoseconds(tickEnd - tickStart);
+  CHECK(measured > wall * 0.8);
+  CHECK(measured < wall * 1.2);
+}
+
+int main() {
+  TestMonotonic();
+  TestNanoseconds();
+  return TestResult();
+}
@@ -0,0 +1,144 @@
+/**
+ * wireformattest.cpp
+ * Binary wire encoding and WireDecoder framing: split and batched reads,
+ * unknown templates, gaps and sequence regressions.
+ */
+#include <string>
+#include <vector>
+#include "testcheck.hpp"
+#include "wireformat.hpp"
+
+// Collects decoded messages
+struct Collector
+{
+  std::vector<StreamMessage> streams;
+  std::vector<ExecutionMessage> executions;
+
+  void OnStream(const StreamMessage &message) { streams.push_back(message); }
+  void OnExecution(const ExecutionMessage &message) { executions.push_back(message); }
+};
+
+std::string Stream(uint64_t sequence, uint32_t productIndex) {
+  StreamMessage message{};
+  message.sequence = sequence;
+  message.productIndex = productIndex;
+  message.timestamp = 1733100000000000000LL;
+  message.bidPrice = 99 * 256 + 1;
+  message.offerPrice = 99 * 256 + 3;
+  message.bidVisibleQuantity = 1000000;
+  message.bidHiddenQuantity = 2000000;
+  message.offerVisibleQuantity = 1000000;
+  message.offerHiddenQuantity = 2000000;
+  char buffer[WIRE_MAX_MESSAGE_LENGTH];
+  return std::string(buffer, EncodeStream(message, buffer));
+}
+
+std::string Execution(uint64_t sequence, uint64_t orderId) {
+  ExecutionMessage message{};
+  message.sequence = sequence;
+  message.productIndex = 3;
+  message.side = 1;
+  message.orderType = 2;
+  message.orderId = orderId;
+  message.price = -5;
+  message.visibleQuantity = 10000000;
+  message.hiddenQuantity = 0;
+  char buffer[WIRE_MAX_MESSAGE_LENGTH];
+  return std::string(buffer, EncodeExecution(message, buffer));
+}
+
+// Every field survives an encode and decode
+void TestRoundTrip() {
+  std::string bytes = Stream(1, 7) + Execution(2, 0xFFFFFFFFFFULL);
+  CHECK_EQUAL(bytes.size(), StreamMessage::LENGTH + ExecutionMessage::LENGTH);
+  WireDecoder decoder;
+  Collector collector;
+  CHECK(decoder.Feed(bytes.data(), bytes.size(), collector));
+  CHECK_EQUAL(collector.streams.size(), 1u);
+  CHECK_EQUAL(collector.executions.size(), 1u);
+  const StreamMessage &stream = collector.streams[0];
+  CHECK_EQUAL(stream.sequence, 1u);
+  CHECK_EQUAL(stream.productIndex, 7u);
+  CHECK_EQUAL(stream.timestamp, 1733100000000000000LL);
+  CHECK_EQUAL(stream.bidPrice, 99 * 256 + 1);
+  CHECK_EQUAL(stream.offerHiddenQuantity, 2000000);
+  const ExecutionMessage &execution = collector.executions[0];
+  CHECK_EQUAL(execution.orderId, 0xFFFFFFFFFFULL);
+  CHECK_EQUAL(execution.price, -5);
+  CHECK_EQUAL(static_cast<int>(execution.side), 1);
+  CHECK_EQUAL(static_cast<int>(execution.orderType), 2);
+}
+
+// Messages split across reads, one byte at a time, are reassembled
+void TestSplitReads() {
+  std::string bytes = Stream(1, 1) + Stream(2, 2) + Execution(3, 42);
+  WireDecoder decoder;
+  Collector collector;
+  for (char byte : bytes) {
+    CHECK(decoder.Feed(&byte, 1, collector));
+  }
+  CHECK_EQUAL(collector.streams.size(), 2u);
+  CHECK_EQUAL(collector.executions.size(), 1u);
+  CHECK_EQUAL(decoder.Gaps(), 0u);
+}
+
+// Unknown templates and newer schemas are skipped by length
+void TestUnknownMessagesSkipped() {
+  std::string unknown = Stream(2, 9);
+  PutWire<uint16_t>(&unknown[2], 99);
+  std::string newer = Stream(3, 9);
+  PutWire<uint16_t>(&newer[4], WIRE_SCHEMA_VERSION + 1);
+  std::string bytes = Stream(1, 1) + unknown + newer + Stream(4, 4);
+  WireDecoder decoder;
+  Collector collector;
+  CHECK(decoder.Feed(bytes.data(), bytes.size(), collector));
+  CHECK_EQUAL(collector.streams.size(), 2u);
+  CHECK_EQUAL(decoder.Skipped(), 2u);
+  CHECK_EQUAL(decoder.Gaps(), 0u);
+}
+
+// Missing sequence numbers are counted as gaps
+void TestGapsCounted() {
+  std::string bytes = Stream(1, 1) + Stream(4, 1) + Stream(5, 1) + Stream(9, 1);
+  WireDecoder decoder;
+  Collector collector;
+  CHECK(decoder.Feed(bytes.data(), bytes.size(), collector));
+  CHECK_EQUAL(collector.streams.size(), 4u);
+  CHECK_EQUAL(decoder.Gaps(), 5u);
+}
+
+// A repeated or earlier sequence number stops decoding with an error
+void TestRegressionRejected() {
+  std::string bytes = Stream(1, 1) + Stream(4, 1) + Stream(3, 1) + Stream(5, 1);
+  WireDecoder decoder;
+  Collector collector;
+  CHECK(!decoder.Feed(bytes.data(), bytes.size(), collector));
+  CHECK_EQUAL(collector.streams.size(), 2u);
+  CHECK_EQUAL(decoder.Regressions(), 1u);
+
+  std::string repeated = Stream(1, 1) + Stream(1, 1);
+  WireDecoder repeatDecoder;
+  Collector repeatCollector;
+  CHECK(!repeatDecoder.Feed(repeated.data(), repeated.size(), repeatCollector));
+  CHECK_EQUAL(repeatCollector.streams.size(), 1u);
+}
+
+// A length shorter than the header is corrupt
+void TestCorruptLength() {
+  std::string bytes = Stream(1, 1);
+  PutWire<uint16_t>(&bytes[0], WIRE_HEADER_LENGTH - 1);
+  WireDecoder decoder;
+  Collector collector;
+  CHECK(!decoder.Feed(bytes.data(), bytes.size(), collector));
+  CHECK(collector.streams.empty());
+}
+
+int main() {
+  TestRoundTrip();
+  TestSplitReads();
+  TestUnknownMessagesSkipped();
+  TestGapsCounted();
+  TestRegressionRejected();
+  TestCorruptLength();
+  return TestResult();
+}
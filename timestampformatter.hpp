@@ -0,0 +1,147 @@
+/**
+ * timestampformatter.hpp
+ * Allocation-free HH:MM:SS.mmm timestamps for the historical data and GUI
+ * output, and a TSC based clock for latency measurement.
+ */
+#ifndef TIMESTAMP_FORMATTER_HPP
+#define TIMESTAMP_FORMATTER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Formats wall-clock times as local "HH:MM:SS.mmm" or "HH:MM:SS.uuuuuu".
+ * The HH:MM:SS prefix is cached per thread and only rebuilt with localtime_r
+ * when the second changes, so most calls are a memcpy and a few digit stores.
+ */
+class TimestampFormatter
+{
+
+public:
+
+  enum Precision { MILLISECONDS, MICROSECONDS };
+
+  // Buffer size that fits the longest timestamp plus a terminating NUL
+  static const size_t MAX_LENGTH = 16;
+
+  // Format the current time into buffer (at least MAX_LENGTH bytes); returns the length
+  static size_t Format(char *buffer, Precision precision = MILLISECONDS) {
+    return Format(std::chrono::system_clock::now(), buffer, precision);
+  }
+
+  // Format the given time into buffer (at least MAX_LENGTH bytes); returns the length
+  static size_t Format(std::chrono::system_clock::time_point time, char *buffer, Precision precision = MILLISECONDS) {
+    long long micros = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+    long long seconds = micros / 1000000;
+    long fraction = static_cast<long>(micros % 1000000);
+    if (fraction < 0) {
+      fraction += 1000000;
+      seconds--;
+    }
+
+    SecondCache &cache = Cache();
+    if (seconds != cache.second) {
+      time_t timeNow = static_cast<time_t>(seconds);
+      struct tm local;
+      localtime_r(&timeNow, &local);
+      WriteTwoDigits(cache.prefix, local.tm_hour);
+      cache.prefix[2] = ':';
+      WriteTwoDigits(cache.prefix + 3, local.tm_min);
+      cache.prefix[5] = ':';
+      WriteTwoDigits(cache.prefix + 6, local.tm_sec);
+      cache.prefix[8] = '.';
+      cache.second = seconds;
+    }
+    memcpy(buffer, cache.prefix, PREFIX_LENGTH);
+
+    size_t digits = 6;
+    if (precision == MILLISECONDS) {
+      fraction /= 1000;
+      digits = 3;
+    }
+    for (size_t i = digits; i > 0; --i) {
+      buffer[PREFIX_LENGTH + i - 1] = static_cast<char>('0' + fraction % 10);
+      fraction /= 10;
+    }
+    buffer[PREFIX_LENGTH + digits] = '\0';
+    return PREFIX_LENGTH + digits;
+  }
+
+private:
+
+  static const size_t PREFIX_LENGTH = 9;  // "HH:MM:SS."
+
+  struct SecondCache {
+    long long second = -1;
+    char prefix[PREFIX_LENGTH];
+  };
+
+  static SecondCache& Cache() {
+    thread_local SecondCache cache;
+    return cache;
+  }
+
+  static void WriteTwoDigits(char *out, int value) {
+    out[0] = static_cast<char>('0' + value / 10);
+    out[1] = static_cast<char>('0' + value % 10);
+  }
+
+};
+
+/**
+ * Monotonic clock reading the CPU timestamp counter where available and
+ * steady_clock elsewhere. Ticks are converted to nanoseconds with a rate
+ * calibrated once against steady_clock. Only differences between readings
+ * are meaningful; use it for latency, not for wall-clock time.
+ */
+class TscClock
+{
+
+public:
+
+  // Read the counter
+  static uint64_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+  }
+
+  // Convert a difference between two readings to nanoseconds
+  static double ToNanoseconds(uint64_t ticks) {
+    return ticks / TicksPerNanosecond();
+  }
+
+  // Counter ticks per nanosecond, calibrated on first use
+  static double TicksPerNanosecond() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const double rate = Calibrate();
+    return rate;
+#else
+    return 1.0;
+#endif
+  }
+
+private:
+
+  static double Calibrate() {
+    auto wallStart = std::chrono::steady_clock::now();
+    uint64_t tickStart = Now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint64_t tickEnd = Now();
+    auto wallEnd = std::chrono::steady_clock::now();
+    double nanos = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(wallEnd - wallStart).count());
+    return nanos > 0 ? (tickEnd - tickStart) / nanos : 1.0;
+  }
+
+};
+
+#endif
@@ -8,9 +8,18 @@
 #define TRADE_BOOKING_SERVICE_HPP
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "soa.hpp"
-#include <map>
+#include "executionservice.hpp"
+#include "securitymaster.hpp"
+#include "productlocks.hpp"
+#include "bookregistry.hpp"
+#include "positiondelta.hpp"
+#include <charconv>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 using namespace std;
 
 // Trade sides
@@ -26,8 +35,8 @@ class Trade
 
 public:
 
-  // ctor for a trade
-  Trade(const T &_product, string _tradeId, double _price, string _book, long _quantity, Side _side);
+  // ctor for a trade; throws out_of_range for a new book once BookRegistry::MAX_BOOKS are in use
+  Trade(const T &_product, string _tradeId, TreasuryPrice _price, string _book, long _quantity, Side _side);
 
   // Get the product
   const T& GetProduct() const;
@@ -36,11 +45,14 @@ public:
   const string& GetTradeId() const;
 
   // Get the mid price
-  double GetPrice() const;
+  TreasuryPrice GetPrice() const;
 
   // Get the book
   const string& GetBook() const;
 
+  // Get the interned ID of the book
+  BookId GetBookId() const;
+
   // Get the quantity
   long GetQuantity() const;
 
@@ -48,10 +60,11 @@ public:
   Side GetSide() const;
 
 private:
-  T product;
+  const T* product;  // points into the product registry
   string tradeId;
-  double price;
+  TreasuryPrice price;
   string book;
+  BookId bookId;
   long quantity;
   Side side;
 
@@ -64,17 +77,24 @@ private:
     vector<string> books = {"TRSY1", "TRSY2", "TRSY3"};
     int orderID = 0;
 public:
-    TradeBookingServiceListener(Service<string,Trade <T> >* _service) : service(_service) {}
+    // Interns the execution books up front, so booking executions never meets a full BookRegistry
+    TradeBookingServiceListener(Service<string,Trade <T> >* _service) : service(_service) {
+      for (const string& book : books) {
+        BookRegistry::Intern(book);
+      }
+    }
 
     void ProcessAdd(ExecutionOrder<T>& data) override {
-      T product = data.GetProduct();
-      double price = data.GetPrice();
-      string book = books[orderID%3];
+      const T& product = data.GetProduct();
+      TreasuryPrice price = data.GetPrice();
+      const string& book = books[orderID%3];
       orderID++;
-      string tradeId = 'E' + to_string(orderID);
+      // Execution trade IDs are 'E' followed by the execution count
+      char tradeId[24] = {'E'};
+      char *tradeIdEnd = std::to_chars(tradeId + 1, tradeId + sizeof(tradeId), orderID).ptr;
       long quantity = data.GetVisibleQuantity() + data.GetHiddenQuantity();
       Side side = data.GetSide() == BID ? BUY : SELL;
-      Trade<T> trade(product, tradeId, price, book, quantity, side);
+      Trade<T> trade(product, string(tradeId, tradeIdEnd), price, book, quantity, side);
       service->OnMessage(trade);
     }
 
@@ -83,9 +103,80 @@ public:
     void ProcessUpdate(ExecutionOrder<T>& data) override {}
 };
 
+/**
+ * Most recent trades of one product, held by value in a bounded ring so memory
+ * stays flat over a trading day. The ring grows as trades arrive up to its
+ * capacity; after that each new trade replaces the oldest one. A trade ID to
+ * slot index, evicted along with the ring, makes lookups constant time.
+ * Type T is the product type.
+ */
+template<typename T>
+class TradeStore
+{
+
+public:
+
+  static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+  // ctor for a store of the most recent capacity trades
+  explicit TradeStore(size_t _capacity = DEFAULT_CAPACITY) :
+    capacity(_capacity == 0 ? 1 : _capacity), next(0), evicted(0)
+  {
+  }
+
+  // Store a trade, evicting the oldest if the store is full
+  void Add(const Trade<T> &trade) {
+    if (trades.size() < capacity) {
+      trades.push_back(trade);
+    }
+    else {
+      // Drop the oldest trade's index entry unless a newer trade reused its ID
+      auto oldest = slots.find(trades[next].GetTradeId());
+      if (oldest != slots.end() && oldest->second == next) {
+        slots.erase(oldest);
+      }
+      trades[next] = trade;
+      evicted++;
+    }
+    slots[trade.GetTradeId()] = next;
+    next = (next + 1) % capacity;
+  }
+
+  // Find the newest trade with the given ID, or nullptr
+  const Trade<T>* Find(const string &tradeId) const {
+    auto slot = slots.find(tradeId);
+    return slot == slots.end() ? nullptr : &trades[slot->second];
+  }
+
+  // Number of trades held
+  size_t Size() const {
+    return trades.size();
+  }
+
+  // Number of trades evicted to make room
+  size_t Evicted() const {
+    return evicted;
+  }
+
+private:
+  size_t capacity;
+  size_t next;     // slot the next trade goes in
+  size_t evicted;
+  vector<Trade<T>> trades;
+  unordered_map<string, size_t> slots;  // newest slot of each trade ID held
+
+};
+
 /**
  * Trade Booking Service to book trades to a particular book.
  * Keyed on trade id.
+ * Trades are stored per product and booked under that product's lock, so
+ * trades arriving from the trade feed and from executions on other threads
+ * only serialise when they are for the same product. Only the most recent
+ * trades of each product are kept (see TradeStore). The lock is held while
+ * listeners run, which keeps the downstream position and risk updates for a
+ * product in booking order. Trade lookups by ID are a cold path: nothing on
+ * the booking path reads trades back.
  * Type T is the product type.
  */
 template<typename T>
@@ -93,31 +184,53 @@ class TradeBookingService : public Service<string,Trade<T>>
 {
 private:
   vector<ServiceListener<Trade<T>>*> listeners;
-  map<string, Trade<T>>* trades;
+  vector<ServiceListener<PositionDelta>*> deltaListeners;
+  vector<TradeStore<T>> trades;  // by product index
+  ProductLocks locks;
   TradeBookingServiceListener<T>* listener;
 
 public:
-  TradeBookingService(){
-    trades = new map<string, Trade<T>>();
+  // ctor for a service keeping the most recent tradesPerProduct trades of each product
+  explicit TradeBookingService(size_t tradesPerProduct = TradeStore<T>::DEFAULT_CAPACITY) :
+    trades(SecurityMaster::Get().Size(), TradeStore<T>(tradesPerProduct)), locks(SecurityMaster::Get().Size())
+  {
     listener = new TradeBookingServiceListener<T>(this);
   }
 
   ~TradeBookingService() {
-    delete trades;
+    delete listener;
   }
 
   // Book the trade
   void BookTrade(Trade<T> &trade) {
-    trades->insert_or_assign(trade.GetTradeId(), trade);
+    uint32_t productIndex = SecurityMaster::Get().IndexOf(trade.GetProduct());
+    lock_guard<mutex> guard(locks[productIndex]);
+    trades[productIndex].Add(trade);
+    if (!deltaListeners.empty()) {
+      long quantity = trade.GetSide() == BUY ? trade.GetQuantity() : -trade.GetQuantity();
+      PositionDelta delta{productIndex, trade.GetBookId(), quantity, 0};
+      for (auto listener : deltaListeners) {
+        listener->ProcessAdd(delta);
+      }
+    }
     for (auto listener : listeners) {
       listener->ProcessAdd(trade);
     }
   }
   
 
-  // Get the trade
-  Trade<T>& GetTrade(const string& tradeId) {
-    return trades->at(tradeId);
+  // Get a copy of the trade, taken under its product's lock, or nothing if it is not held.
+  // A copy because the store slot is reused once the product's ring wraps. Costs one
+  // hash lookup per product, since the trade ID does not say which product it is for
+  optional<Trade<T>> GetTrade(const string& tradeId) {
+    for (uint32_t productIndex = 0; productIndex < trades.size(); ++productIndex) {
+      lock_guard<mutex> guard(locks[productIndex]);
+      const Trade<T>* trade = trades[productIndex].Find(tradeId);
+      if (trade != nullptr) {
+        return *trade;
+      }
+    }
+    return nullopt;
   }
   void OnMessage(Trade<T>& data) override {
     BookTrade(data);
@@ -131,18 +244,26 @@ public:
     return listeners;
   }
 
+  // Add a listener for the position change of each booked trade, called under the product's lock
+  void AddDeltaListener(ServiceListener<PositionDelta>* listener) {
+    deltaListeners.push_back(listener);
+  }
+
+  // Service requires a reference, and no stored trade outlives the ring slot it sits
+  // in, so trades are only returned by value: use GetTrade
   Trade<T>& GetData(string key) override {
-    return trades->at(key);
+    throw logic_error("TradeBookingService returns trades by value; use GetTrade for trade: " + key);
   }
 };
 
 template<typename T>
-Trade<T>::Trade(const T &_product, string _tradeId, double _price, string _book, long _quantity, Side _side) :
-  product(_product)
+Trade<T>::Trade(const T &_product, string _tradeId, TreasuryPrice _price, string _book, long _quantity, Side _side) :
+  product(&_product)
 {
   tradeId = _tradeId;
   price = _price;
   book = _book;
+  bookId = BookRegistry::Intern(book);
   quantity = _quantity;
   side = _side;
 }
@@ -150,7 +271,7 @@ Trade<T>::Trade(const T &_product, string _tradeId, double _price, string _book,
 template<typename T>
 const T& Trade<T>::GetProduct() const
 {
-  return product;
+  return *product;
 }
 
 template<typename T>
@@ -160,7 +281,7 @@ const string& Trade<T>::GetTradeId() const
 }
 
 template<typename T>
-double Trade<T>::GetPrice() const
+TreasuryPrice Trade<T>::GetPrice() const
 {
   return price;
 }
@@ -171,6 +292,12 @@ const string& Trade<T>::GetBook() const
   return book;
 }
 
+template<typename T>
+BookId Trade<T>::GetBookId() const
+{
+  return bookId;
+}
+
 template<typename T>
 long Trade<T>::GetQuantity() const
 {
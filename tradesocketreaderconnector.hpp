@@ -14,20 +14,48 @@
 #include "products.hpp"
 #include "pricesocketreaderconnector.hpp"
 #include "tradebookingservice.hpp"
+#include "fieldparser.hpp"
+#include "lineframer.hpp"
 
 #ifndef TRADESOCKETREADERCONNECTOR_HPP
 #define TRADESOCKETREADERCONNECTOR_HPP
 
 
+// Parse a raw line into a Trade<Bond> object and publish it through the connector
+inline ParseError PublishTradeLine(std::string_view line, Connector<Trade<Bond>>& connector) {
+    TradeRecord record;
+    ParseError error = ParseTradeRecord(line, record);
+    if (error != PARSE_OK) {
+        return error;
+    }
+
+    // Validate CUSIP exists in the product registry
+    const Bond* bond = SecurityMaster::Get().FindBond(record.cusip);
+    if (bond == nullptr) {
+        return PARSE_UNKNOWN_CUSIP;
+    }
+
+    // Positions hold a fixed number of books; reject a new book here rather than throw mid-pipeline
+    BookId bookId;
+    if (!BookRegistry::TryIntern(record.book, bookId)) {
+        return PARSE_TOO_MANY_BOOKS;
+    }
+
+    Trade<Bond> trade(*bond, std::string(record.tradeId), record.price, std::string(record.book), record.quantity, record.side);
+    connector.Publish(trade);
+    return PARSE_OK;
+}
+
 class TradesSocketReaderConnector : public Connector<Trade<Bond>> {
 private:
     int socketFd;
     Service<std::string, Trade<Bond>>* targetService;
     bool running;
+    size_t receiveBufferSize;
 
 public:
-    TradesSocketReaderConnector(int port, Service<std::string, Trade<Bond>>* service) 
-        : targetService(service), running(true) {
+    TradesSocketReaderConnector(int port, Service<std::string, Trade<Bond>>* service, size_t _receiveBufferSize = LineFramer::DEFAULT_CAPACITY) 
+        : targetService(service), running(true), receiveBufferSize(_receiveBufferSize) {
         // Create socket
         socketFd = socket(AF_INET, SOCK_STREAM, 0);
         if (socketFd < 0) {
@@ -81,33 +109,25 @@ public:
                 }
                 std::cerr << "Client connected!" << std::endl;
 
-                std::string accumulated;
-                char buffer[1024];
+                LineFramer framer(receiveBufferSize);
                 while (running) {
-                    int bytesRead = read(clientFd, buffer, sizeof(buffer) - 1);
+                    ssize_t bytesRead = framer.ReadFrom(clientFd);
                     if (bytesRead <= 0) {
                         std::cerr << "Connection closed or error (bytesRead: " << bytesRead << ")" << std::endl;
                         break;
                     }
-                    
-                    buffer[bytesRead] = '\0';
-                    accumulated += buffer;
-                    
-                    size_t pos;
-                    while ((pos = accumulated.find('\n')) != std::string::npos) {
-                        std::string line = accumulated.substr(0, pos);
-                        if (!line.empty() && line[line.length()-1] == '\r') {
-                            line = line.substr(0, line.length()-1);  // Remove \r if present
-                        }
+
+                    framer.ForEachLine([this](std::string_view line) {
                         try {
-                            Trade<Bond> trade_obj = MakeTrade(line);
-                            Publish(trade_obj);
+                            ParseError error = PublishLine(line);
+                            if (error != PARSE_OK) {
+                                std::cerr << "Error processing line: " << ParseErrorString(error) << ": " << line << std::endl;
+                            }
                         }
                         catch (const std::exception& e) {
                             std::cerr << "Error processing line: " << e.what() << std::endl;
                         }
-                        accumulated = accumulated.substr(pos + 1);
-                    }
+                    });
                 }
                 std::cerr << "Client connection closed" << std::endl;
                 close(clientFd);
@@ -122,33 +142,9 @@ public:
         targetService->OnMessage(data);
     }
 
-    // Parse raw string into Price<Bond> object
-    Trade<Bond> MakeTrade(std::string input) {
-        // First check if the string is long enough
-        if (input.length() < 41) {  
-            throw std::runtime_error("Input string too short: " + input);
-        }
-
-        try {
-            std::string CUSIP = input.substr(0, 9);
-            std::string tradeID = input.substr(11, 6);
-            double price = stod(input.substr(19, 3));
-            std::string book = input.substr(24,5);
-            long quantity = stol(input.substr(31, 7));
-            Side side = input.substr(40, 1) == "0" ? BUY : SELL;
-            
-            // Validate CUSIP exists in bondMap
-            if (bondMap.find(CUSIP) == bondMap.end()) {
-                throw std::runtime_error("Unknown CUSIP: " + CUSIP);
-            }
-            return Trade<Bond>(bondMap.find(CUSIP)->second, tradeID, price, book, quantity, side);
-        }
-        catch (const std::out_of_range& e) {
-            throw std::runtime_error("Invalid string format: " + input);
-        }
-        catch (const std::invalid_argument& e) {
-            throw std::runtime_error("Invalid number format in: " + input);
-        }
+    // Parse a raw line into a Trade<Bond> object and publish it to the service
+    ParseError PublishLine(std::string_view line) {
+        return PublishTradeLine(line, *this);
     }
 
     ~TradesSocketReaderConnector() {
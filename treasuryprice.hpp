@@ -0,0 +1,170 @@
+/**
+ * treasuryprice.hpp
+ * Exact Treasury price held as an integer number of 1/256ths of a point, with
+ * table-driven conversion to and from the fractional "99-16+" notation.
+ */
+#ifndef TREASURY_PRICE_HPP
+#define TREASURY_PRICE_HPP
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+/**
+ * A price in 256ths of a point. Every price on the feeds is a whole number of
+ * 256ths, so prices compare, subtract and round trip exactly; convert to
+ * decimal only for analytics and display.
+ */
+class TreasuryPrice
+{
+
+public:
+
+  static constexpr int64_t TICKS_PER_POINT = 256;
+
+  // Longest formatted price: sign, 19 digit handle, "-", 32nds and 256ths digit
+  static constexpr size_t MAX_LENGTH = 24;
+
+  // ctor for a zero price
+  constexpr TreasuryPrice() : ticks(0) {}
+
+  // Price of a whole number of 256ths
+  static constexpr TreasuryPrice FromTicks(int64_t ticks) {
+    return TreasuryPrice(ticks);
+  }
+
+  // Price of a handle, 32nds and 256ths, e.g. 99-16+ is (99, 16, 4)
+  static constexpr TreasuryPrice FromFraction(int64_t handle, int thirtySeconds, int eighths) {
+    return TreasuryPrice(handle * TICKS_PER_POINT + thirtySeconds * 8 + eighths);
+  }
+
+  // Price of a whole number of points
+  static constexpr TreasuryPrice FromPoints(int64_t points) {
+    return TreasuryPrice(points * TICKS_PER_POINT);
+  }
+
+  // Nearest price to a decimal
+  static TreasuryPrice FromDecimal(double price) {
+    return TreasuryPrice(std::llround(price * TICKS_PER_POINT));
+  }
+
+  // Sentinels below and above every real price
+  static constexpr TreasuryPrice Lowest() {
+    return TreasuryPrice(std::numeric_limits<int64_t>::min());
+  }
+
+  static constexpr TreasuryPrice Highest() {
+    return TreasuryPrice(std::numeric_limits<int64_t>::max());
+  }
+
+  // Get the price in 256ths
+  constexpr int64_t Ticks() const {
+    return ticks;
+  }
+
+  // Get the price as a decimal; exact, since 256ths are dyadic
+  constexpr double ToDecimal() const {
+    return static_cast<double>(ticks) / TICKS_PER_POINT;
+  }
+
+  constexpr TreasuryPrice operator+(TreasuryPrice other) const { return TreasuryPrice(ticks + other.ticks); }
+  constexpr TreasuryPrice operator-(TreasuryPrice other) const { return TreasuryPrice(ticks - other.ticks); }
+  constexpr bool operator==(TreasuryPrice other) const { return ticks == other.ticks; }
+  constexpr bool operator!=(TreasuryPrice other) const { return ticks != other.ticks; }
+  constexpr bool operator<(TreasuryPrice other) const { return ticks < other.ticks; }
+  constexpr bool operator<=(TreasuryPrice other) const { return ticks <= other.ticks; }
+  constexpr bool operator>(TreasuryPrice other) const { return ticks > other.ticks; }
+  constexpr bool operator>=(TreasuryPrice other) const { return ticks >= other.ticks; }
+
+  // Write the fractional form ("99-16+", "100-000") to out, at least MAX_LENGTH chars, and return its length
+  size_t Format(char *out) const;
+
+  // Get the fractional form
+  std::string ToString() const {
+    char buffer[MAX_LENGTH];
+    return std::string(buffer, Format(buffer));
+  }
+
+  // Parse the fractional form: a 1-3 digit handle, "-", 32nds 00-31 and a 256ths digit 0-7 or + for 4
+  static bool Parse(std::string_view field, TreasuryPrice &price);
+
+private:
+  int64_t ticks;
+
+  explicit constexpr TreasuryPrice(int64_t _ticks) : ticks(_ticks) {}
+
+};
+
+// "-NNE" suffix for each of the 256 ticks within a point
+constexpr std::array<std::array<char, 4>, 256> MakeFractionSuffixes()
+{
+  std::array<std::array<char, 4>, 256> suffixes{};
+  for (int tick = 0; tick < 256; ++tick) {
+    int thirtySeconds = tick / 8;
+    int eighths = tick % 8;
+    suffixes[tick] = {'-', static_cast<char>('0' + thirtySeconds / 10), static_cast<char>('0' + thirtySeconds % 10),
+                      static_cast<char>(eighths == 4 ? '+' : '0' + eighths)};
+  }
+  return suffixes;
+}
+
+// Value of each character as the 256ths digit, or -1
+constexpr std::array<int8_t, 256> MakeEighthValues()
+{
+  std::array<int8_t, 256> values{};
+  for (int c = 0; c < 256; ++c) {
+    values[c] = -1;
+  }
+  for (int digit = 0; digit < 8; ++digit) {
+    values['0' + digit] = digit;
+  }
+  values['+'] = 4;
+  return values;
+}
+
+inline constexpr std::array<std::array<char, 4>, 256> FRACTION_SUFFIXES = MakeFractionSuffixes();
+inline constexpr std::array<int8_t, 256> EIGHTH_VALUES = MakeEighthValues();
+
+inline size_t TreasuryPrice::Format(char *out) const
+{
+  // Arithmetic shift and mask floor toward the lower point for negative prices too
+  int64_t handle = ticks >> 8;
+  char *end = std::to_chars(out, out + MAX_LENGTH - 4, handle).ptr;
+  const std::array<char, 4> &suffix = FRACTION_SUFFIXES[ticks & 0xFF];
+  end[0] = suffix[0];
+  end[1] = suffix[1];
+  end[2] = suffix[2];
+  end[3] = suffix[3];
+  return end + 4 - out;
+}
+
+inline bool TreasuryPrice::Parse(std::string_view field, TreasuryPrice &price)
+{
+  size_t dash = field.find('-');
+  if (dash == std::string_view::npos || dash == 0 || dash > 3 || field.size() != dash + 4) {
+    return false;
+  }
+  int64_t handle = 0;
+  bool valid = true;
+  for (size_t i = 0; i < dash; ++i) {
+    unsigned digit = static_cast<unsigned char>(field[i]) - '0';
+    valid &= digit <= 9;
+    handle = handle * 10 + digit;
+  }
+  unsigned tens = static_cast<unsigned char>(field[dash + 1]) - '0';
+  unsigned units = static_cast<unsigned char>(field[dash + 2]) - '0';
+  int eighths = EIGHTH_VALUES[static_cast<unsigned char>(field[dash + 3])];
+  unsigned thirtySeconds = tens * 10 + units;
+  valid &= (tens <= 3) & (units <= 9) & (thirtySeconds <= 31) & (eighths >= 0);
+  if (!valid) {
+    return false;
+  }
+  price = FromFraction(handle, thirtySeconds, eighths);
+  return true;
+}
+
+#endif
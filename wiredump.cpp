@@ -0,0 +1,76 @@
+/**
+ * wiredump.cpp
+ * Connects to a binary streaming or execution feed and prints each decoded
+ * message as text, naming products from the security master.
+ * Usage: wire_dump <port> [host] [secmaster file]
+ */
+#include <iostream>
+#include <string>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "securitymaster.hpp"
+#include "wireformat.hpp"
+
+// Prints decoded messages to stdout
+class WirePrinter
+{
+
+public:
+
+  void OnStream(const StreamMessage &message) {
+    std::cout << "STREAM " << message.sequence << "," << ProductId(message.productIndex) << ","
+              << FromWirePrice(message.bidPrice) << "," << FromWirePrice(message.offerPrice) << ","
+              << message.bidVisibleQuantity << "," << message.bidHiddenQuantity << ","
+              << message.offerVisibleQuantity << "," << message.offerHiddenQuantity << "\n";
+  }
+
+  void OnExecution(const ExecutionMessage &message) {
+    std::cout << "EXECUTION " << message.sequence << "," << ProductId(message.productIndex) << ","
+              << message.orderId << "," << (message.side == 0 ? "BUY" : "SELL") << ","
+              << FromWirePrice(message.price) << "," << message.visibleQuantity << "," << message.hiddenQuantity << "\n";
+  }
+
+private:
+
+  std::string ProductId(uint32_t productIndex) {
+    const ProductRegistry &registry = SecurityMaster::Get();
+    return productIndex < registry.Size() ? registry.GetBond(productIndex).GetProductId() : "#" + std::to_string(productIndex);
+  }
+
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <port> [host] [secmaster file]" << std::endl;
+        return 1;
+    }
+    if (argc == 4) {
+        SecurityMaster::SetSource(argv[3]);
+    }
+
+    int socketFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(std::stoi(argv[1]));
+    if (inet_pton(AF_INET, argc >= 3 ? argv[2] : "127.0.0.1", &serverAddr.sin_addr) <= 0 ||
+        connect(socketFd, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
+        perror("Connection failed");
+        return 1;
+    }
+
+    WireDecoder decoder;
+    WirePrinter printer;
+    char buffer[65536];
+    ssize_t received;
+    while ((received = recv(socketFd, buffer, sizeof(buffer), 0)) > 0) {
+        if (!decoder.Feed(buffer, received, printer)) {
+            std::cerr << "Error: " << (decoder.Regressions() > 0 ? "Sequence number went backwards" : "Corrupt message stream") << std::endl;
+            break;
+        }
+    }
+    close(socketFd);
+    std::cerr << decoder.Gaps() << " sequence gaps, " << decoder.Skipped() << " unknown messages" << std::endl;
+    return 0;
+}
@@ -0,0 +1,266 @@
+/**
+ * wireformat.hpp
+ * Compact fixed-layout binary messages for the outbound streaming and
+ * execution feeds, with the encoder used by the connectors and a decoder for
+ * downstream consumers.
+ *
+ * Every message starts with a 16 byte header:
+ *   uint16 length, uint16 templateId, uint16 schemaVersion, uint16 reserved,
+ *   uint64 sequence (per connector, starting at 1)
+ * followed by the template's fields at fixed offsets. All integers are little
+ * endian. Prices are int64 in 256ths of a point; quantities are int64;
+ * products are indexes into the security master, which both sides load.
+ */
+#ifndef WIRE_FORMAT_HPP
+#define WIRE_FORMAT_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Output format of an outbound connector
+enum WireFormat { TEXT_WIRE, BINARY_WIRE };
+
+static const uint16_t WIRE_SCHEMA_VERSION = 1;
+
+enum WireTemplate : uint16_t
+{
+  STREAM_TEMPLATE = 1,
+  EXECUTION_TEMPLATE = 2
+};
+
+static const size_t WIRE_HEADER_LENGTH = 16;
+
+/**
+ * Two-way price stream.
+ */
+struct StreamMessage
+{
+  uint64_t sequence;
+  uint32_t productIndex;
+  int64_t timestamp;        // nanoseconds since the epoch
+  int64_t bidPrice;         // 256ths
+  int64_t offerPrice;       // 256ths
+  int64_t bidVisibleQuantity;
+  int64_t bidHiddenQuantity;
+  int64_t offerVisibleQuantity;
+  int64_t offerHiddenQuantity;
+
+  static const size_t LENGTH = WIRE_HEADER_LENGTH + 8 + 7 * 8;
+};
+
+/**
+ * Execution of an order on the market.
+ */
+struct ExecutionMessage
+{
+  uint64_t sequence;
+  uint32_t productIndex;
+  uint8_t side;             // 0 buy (bid), 1 sell (offer)
+  uint8_t orderType;        // OrderType
+  uint64_t orderId;
+  int64_t price;            // 256ths
+  int64_t visibleQuantity;
+  int64_t hiddenQuantity;
+
+  static const size_t LENGTH = WIRE_HEADER_LENGTH + 8 + 4 * 8;
+};
+
+// Largest message in the schema, for sizing buffers
+static const size_t WIRE_MAX_MESSAGE_LENGTH = StreamMessage::LENGTH > ExecutionMessage::LENGTH ?
+  StreamMessage::LENGTH : ExecutionMessage::LENGTH;
+
+// Convert a wire price to a decimal
+inline double FromWirePrice(int64_t price) {
+  return price / 256.0;
+}
+
+// Store and load little endian integers at a byte position
+template<typename T>
+inline void PutWire(char* out, T value) {
+  typedef typename std::make_unsigned<T>::type U;
+  U bits = static_cast<U>(value);
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    out[i] = static_cast<char>(bits >> (8 * i));
+  }
+}
+
+template<typename T>
+inline T GetWire(const char* in) {
+  typedef typename std::make_unsigned<T>::type U;
+  U bits = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    bits |= static_cast<U>(static_cast<unsigned char>(in[i])) << (8 * i);
+  }
+  return static_cast<T>(bits);
+}
+
+inline void PutWireHeader(char* out, uint16_t length, WireTemplate templateId, uint64_t sequence) {
+  PutWire<uint16_t>(out, length);
+  PutWire<uint16_t>(out + 2, templateId);
+  PutWire<uint16_t>(out + 4, WIRE_SCHEMA_VERSION);
+  PutWire<uint16_t>(out + 6, 0);
+  PutWire<uint64_t>(out + 8, sequence);
+}
+
+// Encode a message into out (at least LENGTH bytes) and return its length
+inline size_t EncodeStream(const StreamMessage &message, char* out) {
+  PutWireHeader(out, StreamMessage::LENGTH, STREAM_TEMPLATE, message.sequence);
+  char* body = out + WIRE_HEADER_LENGTH;
+  PutWire<uint32_t>(body, message.productIndex);
+  PutWire<uint32_t>(body + 4, 0);
+  PutWire<int64_t>(body + 8, message.timestamp);
+  PutWire<int64_t>(body + 16, message.bidPrice);
+  PutWire<int64_t>(body + 24, message.offerPrice);
+  PutWire<int64_t>(body + 32, message.bidVisibleQuantity);
+  PutWire<int64_t>(body + 40, message.bidHiddenQuantity);
+  PutWire<int64_t>(body + 48, message.offerVisibleQuantity);
+  PutWire<int64_t>(body + 56, message.offerHiddenQuantity);
+  return StreamMessage::LENGTH;
+}
+
+inline size_t EncodeExecution(const ExecutionMessage &message, char* out) {
+  PutWireHeader(out, ExecutionMessage::LENGTH, EXECUTION_TEMPLATE, message.sequence);
+  char* body = out + WIRE_HEADER_LENGTH;
+  PutWire<uint32_t>(body, message.productIndex);
+  body[4] = static_cast<char>(message.side);
+  body[5] = static_cast<char>(message.orderType);
+  PutWire<uint16_t>(body + 6, 0);
+  PutWire<uint64_t>(body + 8, message.orderId);
+  PutWire<int64_t>(body + 16, message.price);
+  PutWire<int64_t>(body + 24, message.visibleQuantity);
+  PutWire<int64_t>(body + 32, message.hiddenQuantity);
+  return ExecutionMessage::LENGTH;
+}
+
+// Decode a message whose header has been checked by WireDecoder
+inline void DecodeStream(const char* in, StreamMessage &message) {
+  message.sequence = GetWire<uint64_t>(in + 8);
+  const char* body = in + WIRE_HEADER_LENGTH;
+  message.productIndex = GetWire<uint32_t>(body);
+  message.timestamp = GetWire<int64_t>(body + 8);
+  message.bidPrice = GetWire<int64_t>(body + 16);
+  message.offerPrice = GetWire<int64_t>(body + 24);
+  message.bidVisibleQuantity = GetWire<int64_t>(body + 32);
+  message.bidHiddenQuantity = GetWire<int64_t>(body + 40);
+  message.offerVisibleQuantity = GetWire<int64_t>(body + 48);
+  message.offerHiddenQuantity = GetWire<int64_t>(body + 56);
+}
+
+inline void DecodeExecution(const char* in, ExecutionMessage &message) {
+  message.sequence = GetWire<uint64_t>(in + 8);
+  const char* body = in + WIRE_HEADER_LENGTH;
+  message.productIndex = GetWire<uint32_t>(body);
+  message.side = static_cast<uint8_t>(body[4]);
+  message.orderType = static_cast<uint8_t>(body[5]);
+  message.orderId = GetWire<uint64_t>(body + 8);
+  message.price = GetWire<int64_t>(body + 16);
+  message.visibleQuantity = GetWire<int64_t>(body + 24);
+  message.hiddenQuantity = GetWire<int64_t>(body + 32);
+}
+
+/**
+ * Splits a received byte stream into messages.
+ * Feed it bytes as they arrive; each complete message is passed to the
+ * handler's OnStream or OnExecution. Messages from an unknown template or a
+ * newer schema are skipped by their length. Sequence numbers only increase:
+ * gaps (e.g. from conflation) are counted, and a repeated or earlier sequence
+ * number is an error.
+ */
+class WireDecoder
+{
+
+public:
+
+  WireDecoder() : lastSequence(0), gaps(0), skipped(0), regressions(0) {}
+
+  // Decode the complete messages in data, keeping any partial message for the next call.
+  // Returns false, without decoding further, if the stream is corrupt (a length
+  // shorter than the header) or a sequence number does not increase
+  template<typename Handler>
+  bool Feed(const char* data, size_t length, Handler &handler) {
+    pending.append(data, length);
+    size_t position = 0;
+    bool valid = true;
+    while (pending.size() - position >= WIRE_HEADER_LENGTH) {
+      const char* message = pending.data() + position;
+      uint16_t messageLength = GetWire<uint16_t>(message);
+      if (messageLength < WIRE_HEADER_LENGTH) {
+        valid = false;
+        break;
+      }
+      if (pending.size() - position < messageLength) {
+        break;
+      }
+      if (!Dispatch(message, messageLength, handler)) {
+        valid = false;
+        break;
+      }
+      position += messageLength;
+    }
+    pending.erase(0, position);
+    return valid;
+  }
+
+  // Number of sequence numbers missed so far
+  uint64_t Gaps() const {
+    return gaps;
+  }
+
+  // Number of messages skipped as unknown
+  uint64_t Skipped() const {
+    return skipped;
+  }
+
+  // Number of messages rejected for a sequence number that did not increase
+  uint64_t Regressions() const {
+    return regressions;
+  }
+
+private:
+  std::string pending;
+  uint64_t lastSequence;
+  uint64_t gaps;
+  uint64_t skipped;
+  uint64_t regressions;
+
+  // Returns false if the message's sequence number does not increase
+  template<typename Handler>
+  bool Dispatch(const char* message, uint16_t length, Handler &handler) {
+    uint16_t templateId = GetWire<uint16_t>(message + 2);
+    uint16_t version = GetWire<uint16_t>(message + 4);
+    uint64_t sequence = GetWire<uint64_t>(message + 8);
+    if (sequence <= lastSequence) {
+      regressions++;
+      return false;
+    }
+    if (lastSequence != 0 && sequence > lastSequence + 1) {
+      gaps += sequence - lastSequence - 1;
+    }
+    lastSequence = sequence;
+    if (version != WIRE_SCHEMA_VERSION) {
+      skipped++;
+      return true;
+    }
+    if (templateId == STREAM_TEMPLATE && length >= StreamMessage::LENGTH) {
+      StreamMessage stream;
+      DecodeStream(message, stream);
+      handler.OnStream(stream);
+    }
+    else if (templateId == EXECUTION_TEMPLATE && length >= ExecutionMessage::LENGTH) {
+      ExecutionMessage execution;
+      DecodeExecution(message, execution);
+      handler.OnExecution(execution);
+    }
+    else {
+      skipped++;
+    }
+    return true;
+  }
+
+};
+
+#endif